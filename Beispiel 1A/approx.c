@@ -0,0 +1,257 @@
+/*
+ * Approximate palindrom check. The edit distance between the normalized
+ * string P and its reverse is computed with Myers' bit-vector algorithm, but
+ * only for the cells of the band |row - column| <= k + 1 (Hyyroe's banded
+ * variant). The band is a single 64 bit word which moves down by one row per
+ * column, the cells outside of it are treated as reachable only through the
+ * band, so the computed distance is never too small and it is exact if it is
+ * at most 2k. The rows of the band are compared with the current char of the
+ * reverse in one go, so there is no table per char of the alphabet and the
+ * string is never copied, only a window of it is normalized.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "approx.h"
+
+#ifdef PALINDROM_X86
+#include <immintrin.h>
+#endif
+
+/* === Constants === */
+
+/* number of rows which are compared at once, the band uses at most 63 of them */
+#define WINDOW_BYTES (64)
+
+/* size of the buffer with the normalized window, it is moved to the front once it is full */
+#define WINDOW_BUFFER (4096)
+
+/* === Macros === */
+
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+
+/* === Type Definitions === */
+
+/*
+ * @brief The normalized chars of the string in a window which slides forward
+ */
+struct window {
+	unsigned char chars[ WINDOW_BUFFER ];
+	/* index in the normalized string of chars[0], it is negative at the start */
+	long base;
+	/* number of chars in the buffer */
+	size_t filled;
+	/* index of the next raw char which is normalized */
+	size_t next;
+};
+
+/* === Global Variables === */
+
+/*
+ * @brief the number of edits which is used by the variants, set by approxSelect
+ */
+static int selectedEdits = 0;
+
+/* === Prototypes === */
+
+/*
+ * @brief the implementation of the check, it is inlined into the variants
+ */
+static ALWAYS_INLINE bool approxKernel(const char* input, const size_t length, const bool ignoreSpace,
+                                       const bool ignoreCase, const int maxEdits);
+
+/*
+ * @brief
+ *	makes sure that the window contains the normalized chars [first, first + WINDOW_BYTES),
+ *	chars behind the end of the string are 0
+ *
+ * @return pointer to the char with the index first
+ */
+static ALWAYS_INLINE const unsigned char *slideWindow(struct window *window, const char* input, const size_t length,
+                                                      const bool ignoreSpace, const bool ignoreCase, const long first);
+
+/*
+ * @brief returns a mask with a bit for each of the WINDOW_BYTES chars which is equal to c
+ */
+static inline uint64_t matchMask(const unsigned char *chars, const unsigned char c);
+
+/* === Variants === */
+
+static bool approxPlain(const char* input, const size_t length) {
+	return approxKernel( input , length , false , false , selectedEdits );
+}
+
+static bool approxSpace(const char* input, const size_t length) {
+	return approxKernel( input , length , true , false , selectedEdits );
+}
+
+static bool approxCase(const char* input, const size_t length) {
+	return approxKernel( input , length , false , true , selectedEdits );
+}
+
+static bool approxSpaceCase(const char* input, const size_t length) {
+	return approxKernel( input , length , true , true , selectedEdits );
+}
+
+
+/* === Implementations === */
+
+palindromVariant approxSelect(const bool ignoreSpace, const bool ignoreCase, const int maxEdits) {
+
+	selectedEdits = maxEdits;
+
+	if( ignoreSpace ) {
+		return ignoreCase ? approxSpaceCase : approxSpace;
+	}
+
+	return ignoreCase ? approxCase : approxPlain;
+}
+
+bool isApproxPalindrom(const char* input, const size_t length, const bool ignoreSpace, const bool ignoreCase,
+                       const int maxEdits) {
+	return approxKernel( input , length , ignoreSpace , ignoreCase , maxEdits );
+}
+
+static ALWAYS_INLINE bool approxKernel(const char* input, const size_t length, const bool ignoreSpace,
+                                       const bool ignoreCase, const int maxEdits) {
+
+	/* without edits it is the exact check */
+	if( maxEdits == 0 ) {
+		return isStringPalindrom( input , length , ignoreSpace , ignoreCase );
+	}
+
+	size_t m = length;
+	if( ignoreSpace ) {
+		m = 0;
+		for( size_t i = 0; i < length; i++ ) {
+			m += input[i] != SPACE ? 1 : 0;
+		}
+	}
+
+	/* replacing one half by the mirrored other half always works */
+	if( (size_t)maxEdits >= m / 2 ) {
+		return true;
+	}
+
+	/* bit b of the band is the row column - d + b, the diagonal is bit d */
+	const int d = maxEdits + 1;
+	const int width = 2 * d + 1;
+	const uint64_t bandMask = (UINT64_C(1) << width) - 1;
+	const uint64_t bottom = UINT64_C(1) << (width - 1);
+
+	/* column 0: the row i has the value |i|, rows above the string do not match anything */
+	uint64_t vp = bandMask & ~((UINT64_C(2) << d) - 1);
+	uint64_t vn = (UINT64_C(2) << d) - 1;
+	long score = 0;
+
+	struct window window;
+	memset( window.chars , 0 , WINDOW_BYTES );
+	window.base   = -WINDOW_BYTES;
+	window.filled = WINDOW_BYTES;
+	window.next   = 0;
+
+	/* the reverse is read backwards from the end */
+	size_t backward = length;
+
+	for( size_t j = 1; j <= m; j++ ) {
+
+		do {
+			backward--;
+		} while( ignoreSpace && input[ backward ] == SPACE );
+
+		const unsigned char c = ignoreCase ? palindromLowerTable[ (unsigned char) input[ backward ] ]
+		                                   : (unsigned char) input[ backward ];
+
+		/* row i of the band compares P[i - 1], the first row of the band is j - d */
+		const long first = (long)j - d - 1;
+		const unsigned char *rows = slideWindow( &window , input , length , ignoreSpace , ignoreCase , first );
+
+		/* only the rows 1 .. m belong to the string */
+		const int low  = (long)j - d >= 1 ? 0 : d + 1 - (int)j;
+		const long high = (long)m + d - (long)j < width - 1 ? (long)m + d - (long)j : width - 1;
+		const uint64_t valid = ((UINT64_C(2) << high) - 1) & ~((UINT64_C(1) << low) - 1);
+
+		const uint64_t eq = matchMask( rows , c ) & valid;
+
+		/* the band moves down by one row, the new row is one more than the one above */
+		vp = (vp >> 1) | bottom;
+		vn = vn >> 1;
+
+		const uint64_t x  = eq | vn;
+		const uint64_t d0 = (((x & vp) + vp) ^ vp) | x;
+		uint64_t hp = vn | ~(d0 | vp);
+		uint64_t hn = vp & d0;
+
+		/* the diagonal moves right in the row above it and then down */
+		score += (long)((hp >> (d - 1)) & 1) - (long)((hn >> (d - 1)) & 1);
+
+		/* the row above the band only grows from the band, so it is one more per column */
+		hp = (hp << 1) | 1;
+		hn = hn << 1;
+
+		vp = (hn | ~(d0 | hp)) & bandMask;
+		vn = (hp & d0) & bandMask;
+
+		score += (long)((vp >> d) & 1) - (long)((vn >> d) & 1);
+	}
+
+	return score <= 2 * (long)maxEdits;
+}
+
+static ALWAYS_INLINE const unsigned char *slideWindow(struct window *window, const char* input, const size_t length,
+                                                      const bool ignoreSpace, const bool ignoreCase, const long first) {
+
+	const size_t end = (size_t)(first - window->base) + WINDOW_BYTES;
+
+	/* move the window to the front of the buffer */
+	if( end > WINDOW_BUFFER ) {
+		const size_t shift = (size_t)(first - window->base);
+		memmove( window->chars , window->chars + shift , window->filled - shift );
+		window->filled -= shift;
+		window->base = first;
+	}
+
+	while( window->filled < (size_t)(first - window->base) + WINDOW_BYTES ) {
+		unsigned char c = 0;
+
+		while( window->next < length && ignoreSpace && input[ window->next ] == SPACE ) {
+			window->next++;
+		}
+
+		if( window->next < length ) {
+			c = (unsigned char) input[ window->next++ ];
+			if( ignoreCase ) {
+				c = palindromLowerTable[ c ];
+			}
+		}
+
+		window->chars[ window->filled++ ] = c;
+	}
+
+	return window->chars + (first - window->base);
+}
+
+static inline uint64_t matchMask(const unsigned char *chars, const unsigned char c) {
+
+#ifdef PALINDROM_X86
+	const __m128i needle = _mm_set1_epi8( (char) c );
+	uint64_t mask = 0;
+
+	for( int i = 0; i < WINDOW_BYTES; i += 16 ) {
+		const __m128i block = _mm_loadu_si128( (const __m128i*)(chars + i) );
+		mask |= (uint64_t)(uint32_t) _mm_movemask_epi8( _mm_cmpeq_epi8( block , needle ) ) << i;
+	}
+
+	return mask;
+#else
+	uint64_t mask = 0;
+	for( int i = 0; i < WINDOW_BYTES; i++ ) {
+		mask |= (uint64_t)( chars[i] == c ) << i;
+	}
+
+	return mask;
+#endif
+}
@@ -0,0 +1,57 @@
+/*
+ * This header file does contain the approximate palindrom check. A line is
+ * accepted if it can be turned into a palindrom with at most k edits, an edit
+ * is the substitution, insertion or deletion of a single char.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#ifndef APPROX_H
+#define APPROX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "palindrom.h"
+
+/* === Constants === */
+
+/* the band of the edit distance must fit into 64 bits */
+#define APPROX_MAX_EDITS (30)
+
+/* === Prototypes === */
+
+/*
+ * @brief
+ *	returns the variant of the approximate check which is specialized for the
+ *	flags. The number of edits is stored globally, so all variants which are
+ *	returned use the number of the last call. palindromInit must have been
+ *	called before.
+ *
+ * @param ignoreSpace true if spaces should be ignored
+ * @param ignoreCase true if the case should be ignored
+ * @param maxEdits the number of allowed edits in [0, APPROX_MAX_EDITS]
+ *
+ * @return the variant which checks if a string is an approximate palindrom
+ */
+extern palindromVariant approxSelect(const bool ignoreSpace, const bool ignoreCase, const int maxEdits);
+
+/*
+ * @brief
+ *	checks if the string can be turned into a palindrom with at most maxEdits
+ *	edits. This is the case if the edit distance between the string and its
+ *	reverse is at most 2 * maxEdits, which is computed with a bit-parallel
+ *	algorithm on a band around the diagonal in O(length) time.
+ *
+ * @param input the string which should be checked
+ * @param length the number of chars in input
+ * @param ignoreSpace true if spaces should be ignored
+ * @param ignoreCase true if the case should be ignored
+ * @param maxEdits the number of allowed edits in [0, APPROX_MAX_EDITS]
+ *
+ * @return true if string is an approximate palindrom otherwise not
+ */
+extern bool isApproxPalindrom(const char* input, const size_t length, const bool ignoreSpace, const bool ignoreCase,
+                              const int maxEdits);
+
+#endif
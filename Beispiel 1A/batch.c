@@ -0,0 +1,387 @@
+/*
+ * Batch mode of ispalindrom, every file is mapped into memory and split into
+ * line aligned chunks. The chunks are checked by a pool of worker threads and
+ * the main thread writes the results of the chunks in the order of the input.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "batch.h"
+#include "palindrom.h"
+#include "output.h"
+
+/* === Constants === */
+
+/* nominal size of a chunk, the chunk is extended to the end of the last line */
+#define CHUNK_SIZE (1024 * 1024)
+
+/* number of chunks per worker which may be checked but not written yet */
+#define CHUNKS_IN_FLIGHT (4)
+
+/* === Type Definitions === */
+
+/*
+ * @brief A part of a file with complete lines which is checked by a single worker
+ */
+struct chunk {
+	/* first char of the chunk */
+	const char *begin;
+	/* behind the last char of the chunk */
+	const char *end;
+	/* the results of all lines of this chunk, collected in memory */
+	struct output results;
+	/* true if the worker has finished the chunk */
+	bool done;
+	/* true if the worker ran out of memory */
+	bool failed;
+};
+
+/*
+ * @brief All the state of a single file which is shared between the workers and the main thread
+ */
+struct batchJob {
+	struct chunk *chunks;
+	size_t chunkCount;
+	/* index of the next chunk which should be taken by a worker */
+	size_t nextChunk;
+	/* number of chunks which were already written by the main thread */
+	size_t writtenChunks;
+	/* maximum number of chunks which may be done but not written */
+	size_t window;
+	/* set by a worker which stopped because running was cleared */
+	bool stopped;
+
+	palindromVariant check;
+	/* maximum number of chars of a line or 0 if the length is unbounded */
+	size_t maxLength;
+	const char *tooLongMessage;
+	/* settings of the result caches of the workers, NULL without caches */
+	const struct cacheConfig *cache;
+	struct output *out;
+	volatile sig_atomic_t *running;
+
+	/* protects all the fields above and the done flags of the chunks */
+	pthread_mutex_t lock;
+	/* signaled if a chunk is done */
+	pthread_cond_t chunkDone;
+	/* signaled if a chunk was written */
+	pthread_cond_t chunkWritten;
+};
+
+/* === Prototypes === */
+
+/*
+ * @brief maps the file into memory, checks it and writes the results to the output
+ * @param path the path of the file
+ * @param job the job with the palindrom check, the chunk fields are set by this function
+ * @param threads number of worker threads
+ * @return EXIT_SUCCESS or EXIT_FAILURE
+ */
+static int checkFile(const char *path, struct batchJob *job, const long threads);
+
+/*
+ * @brief splits the data into line aligned chunks
+ * @param data the content of the file
+ * @param size the size of the file
+ * @param chunkCount output parameter for the number of chunks
+ * @return the array of chunks or NULL if out of memory
+ */
+static struct chunk *splitIntoChunks(const char *data, const size_t size, size_t *chunkCount);
+
+/*
+ * @brief entry point of the worker threads, takes chunks until there are no chunks left
+ * @param argument the batchJob
+ * @return always NULL
+ */
+static void *worker(void *argument);
+
+/*
+ * @brief checks all lines of the chunk and writes the results to the output of the chunk
+ * @param job the batchJob with the palindrom check
+ * @param current the chunk which should be checked
+ * @param cache the result cache of the worker or NULL
+ * @return false if out of memory otherwise true
+ */
+static bool checkChunk(const struct batchJob *job, struct chunk *current, struct palindromCache *cache);
+
+
+/* === Implementations === */
+
+int checkFiles(char **files, const int fileCount, const palindromVariant check, const size_t maxLength,
+               const char *tooLongMessage, const long threads, struct output *out,
+               volatile sig_atomic_t *running, const struct cacheConfig *cache) {
+
+	struct batchJob job;
+	job.check       = check;
+	job.maxLength   = maxLength;
+	job.tooLongMessage = tooLongMessage;
+	job.cache       = cache;
+	job.out         = out;
+	job.running     = running;
+	job.window      = threads * CHUNKS_IN_FLIGHT;
+
+	if( pthread_mutex_init( &job.lock , NULL ) != 0
+	 || pthread_cond_init( &job.chunkDone , NULL ) != 0
+	 || pthread_cond_init( &job.chunkWritten , NULL ) != 0 ) {
+		( void ) fprintf( stderr , "Error: Unable to initialize the worker synchronisation!\n" );
+		return EXIT_FAILURE;
+	}
+
+	int ret = EXIT_SUCCESS;
+	for( int i = 0; i < fileCount && *running; i++ ) {
+		if( checkFile( files[i] , &job , threads ) == EXIT_FAILURE ) {
+			ret = EXIT_FAILURE;
+		}
+	}
+
+	( void ) pthread_cond_destroy( &job.chunkWritten );
+	( void ) pthread_cond_destroy( &job.chunkDone );
+	( void ) pthread_mutex_destroy( &job.lock );
+
+	return ret;
+}
+
+static int checkFile(const char *path, struct batchJob *job, const long threads) {
+
+	const int fd = open( path , O_RDONLY );
+	if( fd < 0 ) {
+		( void ) fprintf( stderr , "Error: Unable to open %s: %s\n" , path , strerror( errno ) );
+		return EXIT_FAILURE;
+	}
+
+	struct stat info;
+	if( fstat( fd , &info ) < 0 ) {
+		( void ) fprintf( stderr , "Error: Unable to stat %s: %s\n" , path , strerror( errno ) );
+		( void ) close( fd );
+		return EXIT_FAILURE;
+	}
+
+	/* an empty file does not have any lines, and can not be mapped */
+	if( info.st_size == 0 ) {
+		( void ) close( fd );
+		return EXIT_SUCCESS;
+	}
+
+	const size_t size = (size_t)info.st_size;
+	char *data = mmap( NULL , size , PROT_READ , MAP_PRIVATE , fd , 0 );
+	( void ) close( fd );
+
+	if( data == MAP_FAILED ) {
+		( void ) fprintf( stderr , "Error: Unable to map %s: %s\n" , path , strerror( errno ) );
+		return EXIT_FAILURE;
+	}
+
+	/* the file is read from the front to the back once */
+	( void ) madvise( data , size , MADV_SEQUENTIAL );
+
+	job->chunks = splitIntoChunks( data , size , &job->chunkCount );
+	if( job->chunks == NULL ) {
+		( void ) fprintf( stderr , "Error: Out of Memory!\n" );
+		( void ) munmap( data , size );
+		return EXIT_FAILURE;
+	}
+
+	job->nextChunk     = 0;
+	job->writtenChunks = 0;
+	job->stopped       = false;
+
+	/* there is no need for more workers than chunks */
+	const long workerCount = (size_t)threads < job->chunkCount ? threads : (long)job->chunkCount;
+	pthread_t *workers = (pthread_t*) calloc( workerCount , sizeof(pthread_t) );
+	if( workers == NULL ) {
+		( void ) fprintf( stderr , "Error: Out of Memory!\n" );
+		free( job->chunks );
+		( void ) munmap( data , size );
+		return EXIT_FAILURE;
+	}
+
+	long started = 0;
+	for( ; started < workerCount; started++ ) {
+		if( pthread_create( &workers[ started ] , NULL , worker , job ) != 0 ) {
+			break;
+		}
+	}
+
+	int ret = EXIT_SUCCESS;
+	if( started == 0 ) {
+		( void ) fprintf( stderr , "Error: Unable to start a worker thread!\n" );
+		ret = EXIT_FAILURE;
+		job->stopped = true;
+	}
+
+	/* write the results of the chunks in the order of the file */
+	for( size_t i = 0; i < job->chunkCount && ret == EXIT_SUCCESS; i++ ) {
+		struct chunk *current = &job->chunks[i];
+
+		( void ) pthread_mutex_lock( &job->lock );
+		while( !current->done && !(job->stopped && i >= job->nextChunk) ) {
+			( void ) pthread_cond_wait( &job->chunkDone , &job->lock );
+		}
+		( void ) pthread_mutex_unlock( &job->lock );
+
+		/* the workers stopped before this chunk was taken */
+		if( !current->done ) {
+			break;
+		}
+
+		if( current->failed ) {
+			( void ) fprintf( stderr , "Error: Out of Memory!\n" );
+			ret = EXIT_FAILURE;
+		} else if( !outputAppend( job->out , &current->results ) ) {
+			( void ) fprintf( stderr , "Error: Unable to write the results: %s\n" , strerror( errno ) );
+			ret = EXIT_FAILURE;
+		}
+
+		( void ) outputClose( &current->results );
+
+		( void ) pthread_mutex_lock( &job->lock );
+		job->writtenChunks++;
+		( void ) pthread_cond_broadcast( &job->chunkWritten );
+		( void ) pthread_mutex_unlock( &job->lock );
+	}
+
+	/* tell the workers to stop if the results could not be written */
+	( void ) pthread_mutex_lock( &job->lock );
+	job->nextChunk = job->chunkCount;
+	( void ) pthread_cond_broadcast( &job->chunkWritten );
+	( void ) pthread_mutex_unlock( &job->lock );
+
+	for( long i = 0; i < started; i++ ) {
+		( void ) pthread_join( workers[i] , NULL );
+	}
+
+	/* clean up the chunks which were not written */
+	for( size_t i = 0; i < job->chunkCount; i++ ) {
+		if( job->chunks[i].results.buffer != NULL ) {
+			( void ) outputClose( &job->chunks[i].results );
+		}
+	}
+
+	free( workers );
+	free( job->chunks );
+	( void ) munmap( data , size );
+
+	return ret;
+}
+
+static struct chunk *splitIntoChunks(const char *data, const size_t size, size_t *chunkCount) {
+
+	/* the number of chunks is at most the number of nominal chunks */
+	const size_t maxChunks = size / CHUNK_SIZE + 1;
+	struct chunk *chunks = (struct chunk*) calloc( maxChunks , sizeof(struct chunk) );
+	if( chunks == NULL ) {
+		return NULL;
+	}
+
+	size_t count = 0;
+	const char *begin = data;
+	const char *fileEnd = data + size;
+
+	while( begin < fileEnd ) {
+		const char *end = fileEnd;
+
+		/* extend the chunk to the end of the line which contains the nominal end */
+		if( (size_t)(fileEnd - begin) > CHUNK_SIZE ) {
+			const char *lineEnd = memchr( begin + CHUNK_SIZE , '\n' , fileEnd - begin - CHUNK_SIZE );
+			end = lineEnd != NULL ? lineEnd + 1 : fileEnd;
+		}
+
+		chunks[ count ].begin = begin;
+		chunks[ count ].end   = end;
+		count++;
+
+		begin = end;
+	}
+
+	*chunkCount = count;
+	return chunks;
+}
+
+static void *worker(void *argument) {
+
+	struct batchJob *job = (struct batchJob*) argument;
+
+	/* without memory for the cache the lines are just checked */
+	struct palindromCache cacheMemory;
+	struct palindromCache *cache = NULL;
+	if( job->cache != NULL && cacheInit( &cacheMemory , job->cache , job->check ) ) {
+		cache = &cacheMemory;
+	}
+
+	while( true ) {
+		( void ) pthread_mutex_lock( &job->lock );
+
+		/* do not run too far ahead of the main thread, the results are kept in memory */
+		while( *job->running && job->nextChunk < job->chunkCount
+		    && job->nextChunk >= job->writtenChunks + job->window ) {
+			( void ) pthread_cond_wait( &job->chunkWritten , &job->lock );
+		}
+
+		if( !*job->running || job->nextChunk >= job->chunkCount ) {
+			if( !*job->running ) {
+				job->stopped = true;
+				( void ) pthread_cond_broadcast( &job->chunkDone );
+			}
+			( void ) pthread_mutex_unlock( &job->lock );
+			break;
+		}
+
+		struct chunk *current = &job->chunks[ job->nextChunk++ ];
+		( void ) pthread_mutex_unlock( &job->lock );
+
+		const bool success = outputInit( &current->results , OUTPUT_MEMORY , job->out->format )
+		                  && checkChunk( job , current , cache );
+
+		( void ) pthread_mutex_lock( &job->lock );
+		current->failed = !success;
+		current->done   = true;
+		( void ) pthread_cond_broadcast( &job->chunkDone );
+		( void ) pthread_mutex_unlock( &job->lock );
+	}
+
+	if( cache != NULL ) {
+		cacheFree( cache );
+	}
+
+	return NULL;
+}
+
+static bool checkChunk(const struct batchJob *job, struct chunk *current, struct palindromCache *cache) {
+
+	const char *line = current->begin;
+
+	while( line < current->end ) {
+		const char *lineEnd = memchr( line , '\n' , current->end - line );
+		if( lineEnd == NULL ) {
+			lineEnd = current->end;
+		}
+
+		const size_t length = lineEnd - line;
+
+		/* too long and empty lines are not checked, but they still get a result */
+		if( (job->maxLength > 0 && length > job->maxLength) || length == 0 ) {
+			if( !outputSkipped( &current->results , length > 0 ? job->tooLongMessage : NULL ) ) {
+				return false;
+			}
+		} else {
+			const bool palindrom = cache != NULL ? cacheCheck( cache , line , length ) : job->check( line , length );
+			if( !outputResult( &current->results , line , length , palindrom ) ) {
+				return false;
+			}
+		}
+
+		line = lineEnd + 1;
+	}
+
+	return true;
+}
@@ -0,0 +1,42 @@
+/*
+ * This header file does contain the batch mode of ispalindrom which checks
+ * all lines of whole files. The files are mapped into memory and split into
+ * chunks of lines which are checked by a pool of worker threads.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdbool.h>
+#include <signal.h>
+
+#include "palindrom.h"
+#include "output.h"
+#include "cache.h"
+
+/* === Prototypes === */
+
+/*
+ * @brief
+ *	checks every line of the files and adds the results to the output in the
+ *	order of the input. Errors of single files are printed to stderr and the
+ *	remaining files are still checked.
+ *
+ * @param files the paths of the files which should be checked
+ * @param fileCount number of paths in files
+ * @param check the variant of the palindrom check for the flags
+ * @param maxLength maximum number of chars of a line or 0 if the length is unbounded
+ * @param tooLongMessage the message which is added to the output for a line which is too long
+ * @param threads number of worker threads which check the lines
+ * @param out the output to which the results are added
+ * @param running the files are only checked as long as this flag is true
+ * @param cache the settings of the result caches of the workers or NULL if the results are not cached
+ *
+ * @return EXIT_SUCCESS if all files could be checked otherwise EXIT_FAILURE
+ */
+extern int checkFiles(char **files, const int fileCount, const palindromVariant check, const size_t maxLength,
+                      const char *tooLongMessage, const long threads, struct output *out, volatile sig_atomic_t *running, const struct cacheConfig *cache);
+
+#endif
@@ -0,0 +1,247 @@
+/*
+ * Generates synthetic input for the benchmark of ispalindrom. The palindroms
+ * are mirrored random strings, the other lines are palindroms with a single
+ * changed char, so they are not rejected by the first comparison. The noise
+ * (spaces and case changes) is added afterwards, so with noise the lines are
+ * only palindroms with -s and -i.
+ *
+ * Usage: benchgen [-n lines] [-l distribution] [-p ratio] [-s noise] [-c noise] [-r seed]
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+
+/* === Constants === */
+
+#define OPTSTRING ("n:l:p:s:c:r:")
+#define END_OF_OPTS (-1)
+
+#define DEFAULT_LINES (100000)
+
+/* chars of the generated strings (before noise is added) */
+#define ALPHABET ("abcdefghijklmnopqrstuvwxyz")
+
+/* distributions of the line length */
+#define LENGTH_FIXED (0)
+#define LENGTH_UNIFORM (1)
+#define LENGTH_EXPONENTIAL (2)
+
+/* === Type Definitions === */
+
+/*
+ * @brief The parameters of the generated input
+ */
+struct parameters {
+	long lines;
+	/* one of LENGTH_FIXED, LENGTH_UNIFORM or LENGTH_EXPONENTIAL */
+	int distribution;
+	/* fixed: the length, uniform: the range, exponential: the mean */
+	double minLength;
+	double maxLength;
+	/* probability that a line is a palindrom */
+	double palindromRatio;
+	/* probability that spaces are inserted behind a char */
+	double spaceNoise;
+	/* probability that the case of a char is changed */
+	double caseNoise;
+	unsigned long seed;
+};
+
+/* === Global Variables === */
+
+/* state of the xorshift generator */
+static unsigned long long randomState;
+
+/* === Prototypes === */
+
+/*
+ * @brief Prints the Usage of the Programm
+ * @param command The name of the command (should be argv[0])
+ */
+static void printUsage(const char* const command);
+
+/*
+ * @brief parses the distribution of the line length, "fixed:N", "uniform:MIN:MAX" or "exponential:MEAN"
+ * @return true if the distribution is valid otherwise false
+ */
+static bool parseDistribution(const char *text, struct parameters *parameters);
+
+/*
+ * @brief returns the length of the next line
+ */
+static size_t nextLength(const struct parameters *parameters);
+
+/*
+ * @brief returns a random number in [0, 1)
+ */
+static double nextDouble(void);
+
+/*
+ * @brief returns the next random number of the xorshift64* generator
+ */
+static unsigned long long nextRandom(void);
+
+/* === Implementations === */
+
+/*
+ * @brief Entry point of the generator
+ * @param argc argument count from the command line
+ * @param argv argument string from the command line
+ */
+int main(int argc, char** argv) {
+
+	struct parameters parameters;
+	parameters.lines          = DEFAULT_LINES;
+	parameters.distribution   = LENGTH_UNIFORM;
+	parameters.minLength      = 1;
+	parameters.maxLength      = 40;
+	parameters.palindromRatio = 0.5;
+	parameters.spaceNoise     = 0.0;
+	parameters.caseNoise      = 0.0;
+	parameters.seed           = 1;
+
+	int opt = END_OF_OPTS;
+	bool valid = true;
+	while( (opt=getopt(argc,argv,OPTSTRING)) != END_OF_OPTS && valid ) {
+		char *endptr = NULL;
+		switch( opt ) {
+			case 'n': parameters.lines          = strtol( optarg , &endptr , 10 ); break;
+			case 'p': parameters.palindromRatio = strtod( optarg , &endptr ); break;
+			case 's': parameters.spaceNoise     = strtod( optarg , &endptr ); break;
+			case 'c': parameters.caseNoise      = strtod( optarg , &endptr ); break;
+			case 'r': parameters.seed           = strtoul( optarg , &endptr , 10 ); break;
+			case 'l': valid = parseDistribution( optarg , &parameters ); break;
+			default: valid = false; break;
+		}
+
+		if( endptr != NULL && (endptr == optarg || *endptr != '\0') ) {
+			valid = false;
+		}
+	}
+
+	if( !valid || optind != argc || parameters.lines < 0
+	 || parameters.palindromRatio < 0 || parameters.palindromRatio > 1
+	 || parameters.spaceNoise < 0 || parameters.spaceNoise >= 1
+	 || parameters.caseNoise < 0 || parameters.caseNoise > 1 ) {
+		printUsage( argv[0] );
+		exit( EXIT_FAILURE );
+	}
+
+	/* the state of xorshift must not be 0 */
+	randomState = parameters.seed * 0x9E3779B97F4A7C15ULL + 1;
+
+	const size_t alphabetSize = strlen( ALPHABET );
+	char *line = NULL;
+	size_t capacity = 0;
+
+	for( long n = 0; n < parameters.lines; n++ ) {
+		const size_t length = nextLength( &parameters );
+
+		if( length > capacity ) {
+			capacity = length;
+			line = (char*) realloc( line , capacity );
+			if( line == NULL ) {
+				( void ) fprintf( stderr , "Error: Out of Memory!\n" );
+				exit( EXIT_FAILURE );
+			}
+		}
+
+		/* mirror the first half */
+		for( size_t i = 0; i < (length + 1) / 2; i++ ) {
+			line[i] = line[ length - 1 - i ] = ALPHABET[ nextRandom() % alphabetSize ];
+		}
+
+		/* change a char of the second half (not the middle one) */
+		if( length > 1 && nextDouble() >= parameters.palindromRatio ) {
+			const size_t i = length - 1 - nextRandom() % (length / 2);
+			line[i] = line[i] == 'z' ? 'a' : line[i] + 1;
+		}
+
+		for( size_t i = 0; i < length; i++ ) {
+			char c = line[i];
+			if( nextDouble() < parameters.caseNoise ) {
+				c = c - 'a' + 'A';
+			}
+			putchar_unlocked( c );
+
+			while( nextDouble() < parameters.spaceNoise ) {
+				putchar_unlocked( ' ' );
+			}
+		}
+		putchar_unlocked( '\n' );
+	}
+
+	free( line );
+
+	if( fflush( stdout ) == EOF ) {
+		( void ) fprintf( stderr , "Error: Unable to write the output!\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return EXIT_SUCCESS;
+}
+
+static bool parseDistribution(const char *text, struct parameters *parameters) {
+
+	if( sscanf( text , "fixed:%lf" , &parameters->minLength ) == 1 ) {
+		parameters->distribution = LENGTH_FIXED;
+		return parameters->minLength >= 1;
+	}
+
+	if( sscanf( text , "uniform:%lf:%lf" , &parameters->minLength , &parameters->maxLength ) == 2 ) {
+		parameters->distribution = LENGTH_UNIFORM;
+		return parameters->minLength >= 1 && parameters->minLength <= parameters->maxLength;
+	}
+
+	if( sscanf( text , "exponential:%lf" , &parameters->minLength ) == 1 ) {
+		parameters->distribution = LENGTH_EXPONENTIAL;
+		return parameters->minLength >= 1;
+	}
+
+	return false;
+}
+
+static size_t nextLength(const struct parameters *parameters) {
+
+	switch( parameters->distribution ) {
+		case LENGTH_FIXED:
+			return (size_t) parameters->minLength;
+
+		case LENGTH_UNIFORM: {
+			const size_t range = (size_t) parameters->maxLength - (size_t) parameters->minLength + 1;
+			return (size_t) parameters->minLength + nextRandom() % range;
+		}
+
+		default:
+			/* a few lines are much longer than the mean */
+			return 1 + (size_t)( -log( 1.0 - nextDouble() ) * (parameters->minLength - 1) );
+	}
+}
+
+static double nextDouble(void) {
+	return (double)(nextRandom() >> 11) / (double)(1ULL << 53);
+}
+
+static unsigned long long nextRandom(void) {
+	randomState ^= randomState >> 12;
+	randomState ^= randomState << 25;
+	randomState ^= randomState >> 27;
+	return randomState * 0x2545F4914F6CDD1DULL;
+}
+
+static void printUsage(const char* const command) {
+	( void ) fprintf( stderr , "Usage: %s [-n lines] [-l distribution] [-p ratio] [-s noise] [-c noise] [-r seed]\n"
+				   "-n\t\tNumber of lines (default: %d)\n"
+				   "-l\t\tLength of the lines: fixed:N, uniform:MIN:MAX (default: uniform:1:40) or exponential:MEAN\n"
+				   "-p\t\tProbability that a line is a palindrom (default: 0.5)\n"
+				   "-s\t\tProbability that a space is inserted behind a char (default: 0)\n"
+				   "-c\t\tProbability that a char is upper case (default: 0)\n"
+				   "-r\t\tSeed of the random numbers (default: 1)\n"
+				   , command , DEFAULT_LINES );
+}
@@ -0,0 +1,387 @@
+/*
+ * Benchmark of the implementations of the palindrom check. The input file is
+ * read into memory and every implementation checks all lines: first in a
+ * tight loop for the throughput, then with a timer around every line for the
+ * distribution of the latency. The results are compared with the reference
+ * implementation, so a fast but wrong implementation is noticed. The batch
+ * call of libpalindrome is measured last, it checks all lines at once, so it
+ * has no latency per line.
+ *
+ * Usage: benchmark [-s] [-i] [-r repeats] file
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "palindrom.h"
+#include "utf8.h"
+#include "libpalindrome.h"
+
+/* === Constants === */
+
+#define OPTSTRING ("sir:")
+#define END_OF_OPTS (-1)
+
+#define DEFAULT_REPEATS (5)
+
+/* === Type Definitions === */
+
+/*
+ * @brief A line of the input
+ */
+struct line {
+	const char *data;
+	size_t length;
+};
+
+/*
+ * @brief An implementation which is measured
+ */
+struct implementation {
+	const char *name;
+	/* the generic check, NULL if the variant is used */
+	palindromCheck check;
+	/* the variant which is specialized for the flags */
+	palindromVariant variant;
+};
+
+/* === Global Variables === */
+
+/* the results are added to it, so the compiler can not remove the checks */
+static volatile long resultSink;
+
+/* === Prototypes === */
+
+/*
+ * @brief Prints the Usage of the Programm
+ * @param command The name of the command (should be argv[0])
+ */
+static void printUsage(const char* const command);
+
+/*
+ * @brief reads the whole file into memory and splits it into lines
+ * @return the number of lines or -1 if the file could not be read
+ */
+static long readLines(const char *path, char **content, struct line **lines);
+
+/*
+ * @brief checks the line with the implementation
+ */
+static inline bool runCheck(const struct implementation *implementation, const struct line *line,
+                            const bool ignoreSpace, const bool ignoreCase);
+
+/*
+ * @brief measures an implementation and prints a row of the table
+ */
+static void measure(const struct implementation *implementation, const struct line *lines, const long count,
+                    const size_t bytes, const bool *expected, const bool ignoreSpace, const bool ignoreCase,
+                    const int repeats, unsigned long long *latencies);
+
+/*
+ * @brief measures palindromCheckSpans with all lines as one batch and prints a row of the table
+ */
+static void measureBatch(const struct line *lines, const long count, const size_t bytes, const bool *expected,
+                         const bool ignoreSpace, const bool ignoreCase, const int repeats);
+
+/*
+ * @brief returns the current time in nanoseconds
+ */
+static inline unsigned long long now(void);
+
+/*
+ * @brief compares two latencies for qsort
+ */
+static int compareLatency(const void *a, const void *b);
+
+/* === Implementations === */
+
+/*
+ * @brief Entry point of the benchmark
+ * @param argc argument count from the command line
+ * @param argv argument string from the command line
+ */
+int main(int argc, char** argv) {
+
+	bool ignoreSpace = false;
+	bool ignoreCase  = false;
+	int repeats      = DEFAULT_REPEATS;
+
+	int opt = END_OF_OPTS;
+	while( (opt=getopt(argc,argv,OPTSTRING)) != END_OF_OPTS ) {
+		switch( opt ) {
+			case 's': ignoreSpace = true; break;
+			case 'i': ignoreCase  = true; break;
+			case 'r':
+				repeats = atoi( optarg );
+				if( repeats < 1 ) {
+					printUsage( argv[0] );
+					exit( EXIT_FAILURE );
+				}
+				break;
+			default:
+				printUsage( argv[0] );
+				exit( EXIT_FAILURE );
+		}
+	}
+
+	if( optind + 1 != argc ) {
+		printUsage( argv[0] );
+		exit( EXIT_FAILURE );
+	}
+
+	char *content = NULL;
+	struct line *lines = NULL;
+	const long count = readLines( argv[ optind ] , &content , &lines );
+	if( count < 0 ) {
+		exit( EXIT_FAILURE );
+	}
+
+	palindromInit();
+
+	struct implementation implementations[] = {
+		{ "scalar reference" , isStringPalindromScalar , NULL },
+#ifdef PALINDROM_X86
+		{ "sse2"             , isStringPalindromSSE2   , NULL },
+		{ "avx2"             , isStringPalindromAVX2   , NULL },
+#endif
+		{ "selected variant" , NULL , palindromSelect( ignoreSpace , ignoreCase ) },
+		{ "utf8"             , isUtf8Palindrom         , NULL },
+	};
+	const size_t implementationCount = sizeof(implementations) / sizeof(implementations[0]);
+
+	bool *expected = (bool*) malloc( (size_t)count * sizeof(bool) + 1 );
+	unsigned long long *latencies = (unsigned long long*) malloc( (size_t)count * sizeof(unsigned long long) + 1 );
+	if( expected == NULL || latencies == NULL ) {
+		( void ) fprintf( stderr , "Error: Out of Memory!\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	size_t bytes = 0;
+	long palindroms = 0;
+	for( long i = 0; i < count; i++ ) {
+		expected[i] = isStringPalindromScalar( lines[i].data , lines[i].length , ignoreSpace , ignoreCase );
+		bytes += lines[i].length;
+		palindroms += expected[i] ? 1 : 0;
+	}
+
+	( void ) printf( "%ld lines, %zu bytes, %ld palindroms, flags:%s%s\n\n" , count , bytes , palindroms ,
+	                 ignoreSpace ? " -s" : "" , ignoreCase ? " -i" : "" );
+	( void ) printf( "%-18s %14s %10s %10s %10s %10s %8s\n" ,
+	                 "implementation" , "lines/s" , "MB/s" , "p50 ns" , "p90 ns" , "p99 ns" , "errors" );
+
+	for( size_t i = 0; i < implementationCount; i++ ) {
+#ifdef PALINDROM_X86
+		if( implementations[i].check == isStringPalindromAVX2 && !__builtin_cpu_supports( "avx2" ) ) {
+			continue;
+		}
+#endif
+		measure( &implementations[i] , lines , count , bytes , expected , ignoreSpace , ignoreCase , repeats , latencies );
+	}
+
+	measureBatch( lines , count , bytes , expected , ignoreSpace , ignoreCase , repeats );
+
+	free( latencies );
+	free( expected );
+	free( lines );
+	free( content );
+
+	return EXIT_SUCCESS;
+}
+
+static void measure(const struct implementation *implementation, const struct line *lines, const long count,
+                    const size_t bytes, const bool *expected, const bool ignoreSpace, const bool ignoreCase,
+                    const int repeats, unsigned long long *latencies) {
+
+	/* throughput: the best of several passes over all lines */
+	long errors = 0;
+	unsigned long long best = 0;
+	for( int r = 0; r < repeats; r++ ) {
+		long results = 0;
+		const unsigned long long start = now();
+		for( long i = 0; i < count; i++ ) {
+			results += runCheck( implementation , &lines[i] , ignoreSpace , ignoreCase ) ? 1 : 0;
+		}
+		const unsigned long long elapsed = now() - start;
+
+		if( r == 0 || elapsed < best ) {
+			best = elapsed;
+		}
+
+		resultSink += results;
+	}
+
+	/* latency: every line on its own, the cost of the timer is subtracted */
+	unsigned long long timerCost = ~0ULL;
+	for( int r = 0; r < 1000; r++ ) {
+		const unsigned long long start = now();
+		const unsigned long long elapsed = now() - start;
+		if( elapsed < timerCost ) {
+			timerCost = elapsed;
+		}
+	}
+
+	for( long i = 0; i < count; i++ ) {
+		const unsigned long long start = now();
+		const bool palindrom = runCheck( implementation , &lines[i] , ignoreSpace , ignoreCase );
+		const unsigned long long elapsed = now() - start;
+
+		latencies[i] = elapsed > timerCost ? elapsed - timerCost : 0;
+		if( palindrom != expected[i] ) {
+			errors++;
+		}
+	}
+
+	qsort( latencies , (size_t)count , sizeof(latencies[0]) , compareLatency );
+
+	const double seconds = best > 0 ? (double)best / 1e9 : 1e-9;
+	const long last = count > 0 ? count - 1 : 0;
+
+	( void ) printf( "%-18s %14.0f %10.1f %10llu %10llu %10llu %8ld\n" , implementation->name ,
+	                 (double)count / seconds , (double)bytes / seconds / 1e6 ,
+	                 count > 0 ? latencies[ last * 50 / 100 ] : 0 ,
+	                 count > 0 ? latencies[ last * 90 / 100 ] : 0 ,
+	                 count > 0 ? latencies[ last * 99 / 100 ] : 0 ,
+	                 errors );
+}
+
+static void measureBatch(const struct line *lines, const long count, const size_t bytes, const bool *expected,
+                         const bool ignoreSpace, const bool ignoreCase, const int repeats) {
+
+	struct palindromSpan *spans = (struct palindromSpan*) malloc( (size_t)count * sizeof(struct palindromSpan) + 1 );
+	unsigned char *bitmap = (unsigned char*) malloc( ((size_t)count + 7) / 8 + 1 );
+	if( spans == NULL || bitmap == NULL ) {
+		( void ) fprintf( stderr , "Error: Out of Memory!\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	for( long i = 0; i < count; i++ ) {
+		spans[i].data   = lines[i].data;
+		spans[i].length = lines[i].length;
+	}
+
+	const unsigned int flags = (ignoreSpace ? PALINDROM_IGNORE_SPACE : 0U) | (ignoreCase ? PALINDROM_IGNORE_CASE : 0U);
+
+	/* throughput: the best of several calls with all lines */
+	unsigned long long best = 0;
+	for( int r = 0; r < repeats; r++ ) {
+		const unsigned long long start = now();
+		( void ) palindromCheckSpans( spans , (size_t)count , flags , bitmap );
+		const unsigned long long elapsed = now() - start;
+
+		if( r == 0 || elapsed < best ) {
+			best = elapsed;
+		}
+
+		resultSink += bitmap[0];
+	}
+
+	long errors = 0;
+	for( long i = 0; i < count; i++ ) {
+		if( ((bitmap[ i / 8 ] >> (i % 8)) & 1) != (expected[i] ? 1 : 0) ) {
+			errors++;
+		}
+	}
+
+	const double seconds = best > 0 ? (double)best / 1e9 : 1e-9;
+
+	( void ) printf( "%-18s %14.0f %10.1f %10s %10s %10s %8ld\n" , "batch call" ,
+	                 (double)count / seconds , (double)bytes / seconds / 1e6 , "-" , "-" , "-" , errors );
+
+	free( bitmap );
+	free( spans );
+}
+
+static inline bool runCheck(const struct implementation *implementation, const struct line *line,
+                            const bool ignoreSpace, const bool ignoreCase) {
+
+	if( implementation->check != NULL ) {
+		return implementation->check( line->data , line->length , ignoreSpace , ignoreCase );
+	}
+
+	return implementation->variant( line->data , line->length );
+}
+
+static long readLines(const char *path, char **content, struct line **lines) {
+
+	FILE *file = fopen( path , "rb" );
+	if( file == NULL ) {
+		( void ) fprintf( stderr , "Error: Unable to open %s\n" , path );
+		return -1;
+	}
+
+	struct stat info;
+	if( fstat( fileno( file ) , &info ) < 0 ) {
+		( void ) fprintf( stderr , "Error: Unable to stat %s\n" , path );
+		( void ) fclose( file );
+		return -1;
+	}
+
+	const size_t size = (size_t) info.st_size;
+	*content = (char*) malloc( size + 1 );
+	if( *content == NULL || fread( *content , 1 , size , file ) != size ) {
+		( void ) fprintf( stderr , "Error: Unable to read %s\n" , path );
+		( void ) fclose( file );
+		return -1;
+	}
+	( void ) fclose( file );
+
+	long count = 0;
+	for( size_t i = 0; i < size; i++ ) {
+		count += (*content)[i] == '\n' ? 1 : 0;
+	}
+	if( size > 0 && (*content)[ size - 1 ] != '\n' ) {
+		count++;
+	}
+
+	*lines = (struct line*) malloc( (size_t)count * sizeof(struct line) + 1 );
+	if( *lines == NULL ) {
+		( void ) fprintf( stderr , "Error: Out of Memory!\n" );
+		return -1;
+	}
+
+	long n = 0;
+	const char *begin = *content;
+	const char *end = *content + size;
+	while( begin < end ) {
+		const char *newline = memchr( begin , '\n' , (size_t)(end - begin) );
+		if( newline == NULL ) {
+			newline = end;
+		}
+
+		(*lines)[ n ].data   = begin;
+		(*lines)[ n ].length = (size_t)(newline - begin);
+		n++;
+
+		begin = newline + 1;
+	}
+
+	return n;
+}
+
+static inline unsigned long long now(void) {
+	struct timespec time;
+	( void ) clock_gettime( CLOCK_MONOTONIC , &time );
+	return (unsigned long long) time.tv_sec * 1000000000ULL + (unsigned long long) time.tv_nsec;
+}
+
+static int compareLatency(const void *a, const void *b) {
+	const unsigned long long x = *(const unsigned long long*) a;
+	const unsigned long long y = *(const unsigned long long*) b;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static void printUsage(const char* const command) {
+	( void ) fprintf( stderr , "Usage: %s [-s] [-i] [-r repeats] file\n"
+				   "-s\t\tIgnores spaces in the input\n"
+				   "-i\t\tIgnores character case in the input\n"
+				   "-r\t\tNumber of passes for the throughput, the best one is reported (default: %d)\n"
+				   , command , DEFAULT_REPEATS );
+}
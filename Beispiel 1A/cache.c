@@ -0,0 +1,225 @@
+/*
+ * Result cache of the palindrom check. Each set has four entries and fills
+ * a single cache line, the entries of a set are kept in the order of their
+ * last use. A lookup hashes the normalized line 8 bytes at a time, which is
+ * cheaper than the check for long lines and costs a single cache line.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "cache.h"
+
+/* === Constants === */
+
+#define CACHE_WAYS (4)
+#define CACHE_LINE (64)
+
+/* the lowest bit of the second hash stores the result, the next one marks a used entry */
+#define ENTRY_RESULT (UINT64_C(1))
+#define ENTRY_VALID (UINT64_C(2))
+#define ENTRY_FLAGS (ENTRY_RESULT | ENTRY_VALID)
+
+#define HASH_SEED_A (UINT64_C(0x243F6A8885A308D3))
+#define HASH_SEED_B (UINT64_C(0x13198A2E03707344))
+#define HASH_KEY_A (UINT64_C(0x9E3779B97F4A7C15))
+#define HASH_KEY_B (UINT64_C(0xC2B2AE3D27D4EB4F))
+
+/* SWAR constants, every byte of a word is handled on its own */
+#define BYTES(x) (UINT64_C(0x0101010101010101) * (x))
+#define HIGH_BITS (BYTES(0x80))
+
+/* === Type Definitions === */
+
+__extension__ typedef unsigned __int128 uint128;
+
+/*
+ * @brief A cached result, the line is identified by both hashes
+ */
+struct cacheEntry {
+	uint64_t hashA;
+	/* the second hash with ENTRY_FLAGS */
+	uint64_t hashB;
+};
+
+struct cacheSet {
+	/* the most recently used entry is the first one */
+	struct cacheEntry ways[ CACHE_WAYS ];
+};
+
+/* === Prototypes === */
+
+/*
+ * @brief computes the two hashes of the normalized line
+ */
+static void hashLine(const struct palindromCache *cache, const char* input, const size_t length,
+                     uint64_t *hashA, uint64_t *hashB);
+
+/*
+ * @brief adds 8 bytes of the normalized line to the hashes
+ */
+static inline void mixWord(const uint64_t word, uint64_t *hashA, uint64_t *hashB);
+
+/*
+ * @brief multiplies both values and folds the 128 bit product into 64 bits
+ */
+static inline uint64_t multiplyFold(const uint64_t a, const uint64_t b);
+
+/*
+ * @brief converts the ASCII upper case letters of all 8 bytes to lower case (like tolower in the C locale)
+ */
+static inline uint64_t lowerWord(const uint64_t word);
+
+/* === Implementations === */
+
+bool cacheInit(struct palindromCache *cache, const struct cacheConfig *config, const palindromVariant check) {
+
+	size_t sets = 1;
+	while( sets * CACHE_WAYS < config->entries ) {
+		sets *= 2;
+	}
+
+	void *memory = NULL;
+	if( posix_memalign( &memory , CACHE_LINE , sets * sizeof(struct cacheSet) ) != 0 ) {
+		return false;
+	}
+	memset( memory , 0 , sets * sizeof(struct cacheSet) );
+
+	cache->sets        = (struct cacheSet*) memory;
+	cache->setMask     = sets - 1;
+	cache->ignoreSpace = config->ignoreSpace;
+	cache->ignoreCase  = config->ignoreCase;
+	cache->check       = check;
+	cache->total       = config->stats;
+
+	cache->stats.hits      = 0;
+	cache->stats.misses    = 0;
+	cache->stats.evictions = 0;
+
+	return true;
+}
+
+bool cacheCheck(struct palindromCache *cache, const char* input, const size_t length) {
+
+	uint64_t hashA, hashB;
+	hashLine( cache , input , length , &hashA , &hashB );
+
+	const uint64_t tag = (hashB & ~ENTRY_FLAGS) | ENTRY_VALID;
+	struct cacheEntry *ways = cache->sets[ hashA & cache->setMask ].ways;
+
+	for( int way = 0; way < CACHE_WAYS; way++ ) {
+		if( ways[ way ].hashA == hashA && (ways[ way ].hashB & ~ENTRY_RESULT) == tag ) {
+			const struct cacheEntry hit = ways[ way ];
+
+			/* move the entry to the front */
+			memmove( &ways[1] , &ways[0] , (size_t)way * sizeof(struct cacheEntry) );
+			ways[0] = hit;
+
+			cache->stats.hits++;
+			return (hit.hashB & ENTRY_RESULT) != 0;
+		}
+	}
+
+	const bool palindrom = cache->check( input , length );
+
+	/* the least recently used entry is dropped */
+	if( ways[ CACHE_WAYS - 1 ].hashB & ENTRY_VALID ) {
+		cache->stats.evictions++;
+	}
+
+	memmove( &ways[1] , &ways[0] , (CACHE_WAYS - 1) * sizeof(struct cacheEntry) );
+	ways[0].hashA = hashA;
+	ways[0].hashB = tag | (palindrom ? ENTRY_RESULT : 0);
+
+	cache->stats.misses++;
+	return palindrom;
+}
+
+void cacheFree(struct palindromCache *cache) {
+
+	if( cache->total != NULL ) {
+		( void ) __atomic_fetch_add( &cache->total->hits , cache->stats.hits , __ATOMIC_RELAXED );
+		( void ) __atomic_fetch_add( &cache->total->misses , cache->stats.misses , __ATOMIC_RELAXED );
+		( void ) __atomic_fetch_add( &cache->total->evictions , cache->stats.evictions , __ATOMIC_RELAXED );
+	}
+
+	free( cache->sets );
+	cache->sets = NULL;
+}
+
+static void hashLine(const struct palindromCache *cache, const char* input, const size_t length,
+                     uint64_t *hashA, uint64_t *hashB) {
+
+	*hashA = HASH_SEED_A;
+	*hashB = HASH_SEED_B;
+
+	uint64_t word = 0;
+	size_t normalized = 0;
+
+	if( cache->ignoreSpace ) {
+		/* the spaces are removed, so the words are assembled byte by byte */
+		for( size_t i = 0; i < length; i++ ) {
+			unsigned char c = (unsigned char) input[i];
+			if( c == SPACE ) {
+				continue;
+			}
+
+			if( cache->ignoreCase ) {
+				c = palindromLowerTable[ c ];
+			}
+
+			word |= (uint64_t) c << (8 * (normalized % sizeof(word)));
+			normalized++;
+
+			if( normalized % sizeof(word) == 0 ) {
+				mixWord( word , hashA , hashB );
+				word = 0;
+			}
+		}
+	} else {
+		size_t i = 0;
+		for( ; i + sizeof(word) <= length; i += sizeof(word) ) {
+			uint64_t block;
+			memcpy( &block , input + i , sizeof(block) );
+			mixWord( cache->ignoreCase ? lowerWord( block ) : block , hashA , hashB );
+		}
+
+		for( ; i < length; i++ ) {
+			const unsigned char c = (unsigned char) input[i];
+			word |= (uint64_t)( cache->ignoreCase ? palindromLowerTable[ c ] : c ) << (8 * (i % sizeof(word)));
+		}
+
+		normalized = length;
+	}
+
+	/* the incomplete word is padded with zeros, the length tells the padding apart from chars */
+	if( normalized % sizeof(word) != 0 ) {
+		mixWord( word , hashA , hashB );
+	}
+	mixWord( (uint64_t) normalized , hashA , hashB );
+}
+
+static inline void mixWord(const uint64_t word, uint64_t *hashA, uint64_t *hashB) {
+	*hashA = multiplyFold( *hashA ^ word , HASH_KEY_A );
+	*hashB = multiplyFold( *hashB ^ word ^ HASH_KEY_A , HASH_KEY_B );
+}
+
+static inline uint64_t multiplyFold(const uint64_t a, const uint64_t b) {
+	const uint128 product = (uint128) a * b;
+	return (uint64_t) product ^ (uint64_t)(product >> 64);
+}
+
+static inline uint64_t lowerWord(const uint64_t word) {
+
+	/* the high bit of a byte is set if the 7 low bits are >= 'A' respectively > 'Z' */
+	const uint64_t low   = word & ~HIGH_BITS;
+	const uint64_t fromA = low + BYTES( 0x80 - 'A' );
+	const uint64_t pastZ = low + BYTES( 0x80 - 'Z' - 1 );
+
+	/* only ASCII bytes are converted */
+	const uint64_t upper = (fromA ^ pastZ) & ~word & HIGH_BITS;
+
+	return word | (upper >> 2);
+}
@@ -0,0 +1,91 @@
+/*
+ * This header file does contain the result cache of the palindrom check. The
+ * results are stored by a 128 bit hash of the normalized line, so lines which
+ * are repeated are answered without checking them again. The cache has a
+ * fixed size, the least recently used entry of a set is replaced.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "palindrom.h"
+
+/* === Type Definitions === */
+
+/*
+ * @brief The counters of one or more caches
+ */
+struct cacheStats {
+	uint64_t hits;
+	uint64_t misses;
+	/* number of entries which were replaced by a new entry */
+	uint64_t evictions;
+};
+
+/*
+ * @brief The settings of the caches, every worker thread has its own cache
+ */
+struct cacheConfig {
+	/* number of entries of a cache, it is rounded up to a power of two */
+	size_t entries;
+	/* true if spaces are removed before the line is hashed */
+	bool ignoreSpace;
+	/* true if the line is converted to lower case before it is hashed */
+	bool ignoreCase;
+	/* the counters of all caches are added to it once they are freed */
+	struct cacheStats *stats;
+};
+
+/* a set of entries which fills a cache line, defined in cache.c */
+struct cacheSet;
+
+/*
+ * @brief A cache of the results of the palindrom check, it must only be used by a single thread
+ */
+struct palindromCache {
+	struct cacheSet *sets;
+	size_t setMask;
+	bool ignoreSpace;
+	bool ignoreCase;
+	/* the check which is used if the line is not in the cache */
+	palindromVariant check;
+	struct cacheStats stats;
+	struct cacheStats *total;
+};
+
+/* === Prototypes === */
+
+/*
+ * @brief
+ *	initializes an empty cache. The normalization of the config must not make
+ *	lines equal which may have different results with check.
+ *
+ * @param cache the cache which should be initialized
+ * @param config the settings of the cache
+ * @param check the palindrom check which is used if a line is not in the cache
+ *
+ * @return false if out of memory otherwise true
+ */
+extern bool cacheInit(struct palindromCache *cache, const struct cacheConfig *config, const palindromVariant check);
+
+/*
+ * @brief returns the result of check for the line, from the cache if the line was checked before
+ * @param cache the cache
+ * @param input the line
+ * @param length the number of chars in input
+ * @return true if the line is a palindrom otherwise not
+ */
+extern bool cacheCheck(struct palindromCache *cache, const char* input, const size_t length);
+
+/*
+ * @brief adds the counters to the stats of the config (atomically) and frees the cache
+ */
+extern void cacheFree(struct palindromCache *cache);
+
+#endif
@@ -0,0 +1,344 @@
+/*
+ * Palindromic tree (eertree). A line is added char by char, the node of the
+ * longest palindromic suffix is extended by following the suffix links until
+ * the char in front of the suffix matches. The nodes are kept in an arena and
+ * refer to each other by index, so growing the arena does not invalidate any
+ * link. A node is created after the node of its suffix link, so the counts
+ * can be propagated to the suffixes in a single pass backwards.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "eertree.h"
+#include "palindrom.h"
+
+/* === Constants === */
+
+/* the root with the length -1, every char is a palindrom around it */
+#define ROOT_IMAGINARY (0)
+/* the root with the empty palindrom */
+#define ROOT_EMPTY (1)
+
+#define INITIAL_NODES (1024)
+/* must be a power of two */
+#define INITIAL_EDGES (2048)
+
+/* the nodes are referred to by 32 bit indices */
+#define MAX_NODES ((size_t) UINT32_MAX)
+
+#define HASH_KEY (UINT64_C(0x9E3779B97F4A7C15))
+
+/* === Prototypes === */
+
+/*
+ * @brief returns the node of the palindrom of node with c on both sides or 0 if it is not in the tree
+ */
+static inline uint32_t findEdge(const struct eertree *tree, const uint32_t node, const unsigned char c);
+
+/*
+ * @brief adds the transition, the edge must not be in the tree yet
+ * @return false if out of memory otherwise true
+ */
+static bool addEdge(struct eertree *tree, const uint32_t node, const unsigned char c, const uint32_t target);
+
+/*
+ * @brief
+ *	follows the suffix links from node until the palindrom of the node is
+ *	preceded by the char at position end in chars
+ */
+static inline uint32_t findSuffix(const struct eertree *tree, const unsigned char *chars, const size_t end, uint32_t node);
+
+/*
+ * @brief makes sure that the arena can hold one more node
+ * @return false if out of memory otherwise true
+ */
+static bool reserveNode(struct eertree *tree);
+
+/*
+ * @brief grows the buffer to at least count elements of the size
+ * @return false if out of memory otherwise true
+ */
+static bool reserveArray(void **array, size_t *capacity, const size_t count, const size_t size);
+
+/*
+ * @brief returns true if the node a should be reported in front of the node b
+ */
+static inline bool moreFrequent(const struct eertreeNode *a, const struct eertreeNode *b);
+
+/* === Implementations === */
+
+bool eertreeInit(struct eertree *tree, const bool ignoreSpace, const bool ignoreCase) {
+
+	tree->ignoreSpace       = ignoreSpace;
+	tree->ignoreCase        = ignoreCase;
+	tree->nodeCapacity      = INITIAL_NODES;
+	tree->edgeCapacity      = INITIAL_EDGES;
+	tree->chars             = NULL;
+	tree->charCapacity      = 0;
+	tree->histogram         = NULL;
+	tree->histogramCapacity = 0;
+
+	tree->nodes = (struct eertreeNode*) malloc( tree->nodeCapacity * sizeof(struct eertreeNode) );
+	tree->edges = (struct eertreeEdge*) malloc( tree->edgeCapacity * sizeof(struct eertreeEdge) );
+
+	if( tree->nodes == NULL || tree->edges == NULL ) {
+		eertreeFree( tree );
+		return false;
+	}
+
+	eertreeReset( tree );
+	return true;
+}
+
+void eertreeReset(struct eertree *tree) {
+
+	/* the suffix link of both roots is the imaginary root */
+	tree->nodes[ ROOT_IMAGINARY ].length = -1;
+	tree->nodes[ ROOT_IMAGINARY ].link   = ROOT_IMAGINARY;
+	tree->nodes[ ROOT_IMAGINARY ].parent = ROOT_IMAGINARY;
+	tree->nodes[ ROOT_IMAGINARY ].count  = 0;
+	tree->nodes[ ROOT_IMAGINARY ].c      = 0;
+
+	tree->nodes[ ROOT_EMPTY ] = tree->nodes[ ROOT_IMAGINARY ];
+	tree->nodes[ ROOT_EMPTY ].length = 0;
+
+	tree->nodeCount = 2;
+
+	memset( tree->edges , 0 , tree->edgeCapacity * sizeof(struct eertreeEdge) );
+	tree->edgeCount = 0;
+}
+
+void eertreeFree(struct eertree *tree) {
+	free( tree->nodes );
+	free( tree->edges );
+	free( tree->chars );
+	free( tree->histogram );
+
+	tree->nodes     = NULL;
+	tree->edges     = NULL;
+	tree->chars     = NULL;
+	tree->histogram = NULL;
+}
+
+bool eertreeAddLine(struct eertree *tree, const char *line, const size_t length) {
+
+	if( !reserveArray( (void**) &tree->chars , &tree->charCapacity , length , sizeof(unsigned char) ) ) {
+		return false;
+	}
+
+	/* normalize the line, so the tree only has to compare bytes */
+	size_t count = 0;
+	for( size_t i = 0; i < length; i++ ) {
+		const unsigned char c = (unsigned char) line[i];
+
+		if( tree->ignoreSpace && c == SPACE ) {
+			continue;
+		}
+		tree->chars[ count++ ] = tree->ignoreCase ? palindromLowerTable[ c ] : c;
+	}
+
+	/* a palindrom must not reach into the previous line */
+	uint32_t suffix = ROOT_EMPTY;
+
+	for( size_t i = 0; i < count; i++ ) {
+		const unsigned char c = tree->chars[i];
+
+		const uint32_t node = findSuffix( tree , tree->chars , i , suffix );
+		suffix = findEdge( tree , node , c );
+
+		if( suffix == 0 ) {
+			if( !reserveNode( tree ) ) {
+				return false;
+			}
+
+			const uint32_t created = (uint32_t) tree->nodeCount;
+			struct eertreeNode *next = &tree->nodes[ created ];
+			next->length = tree->nodes[ node ].length + 2;
+			next->parent = node;
+			next->count  = 0;
+			next->c      = c;
+
+			/* the longest proper suffix is found the same way starting behind the palindrom */
+			next->link = ROOT_EMPTY;
+			if( next->length > 1 ) {
+				next->link = findEdge( tree , findSuffix( tree , tree->chars , i , tree->nodes[ node ].link ) , c );
+			}
+
+			if( !addEdge( tree , node , c , created ) ) {
+				return false;
+			}
+
+			tree->nodeCount++;
+			suffix = created;
+		}
+
+		/* only the longest palindrom ending here is counted, its suffixes get it later */
+		tree->nodes[ suffix ].count++;
+	}
+
+	return true;
+}
+
+bool eertreeStats(struct eertree *tree, struct eertreeStats *stats) {
+
+	stats->distinct = tree->nodeCount - 2;
+	stats->topCount = 0;
+	stats->longest  = 0;
+
+	for( size_t i = 2; i < tree->nodeCount; i++ ) {
+		if( (size_t) tree->nodes[i].length > stats->longest ) {
+			stats->longest = (size_t) tree->nodes[i].length;
+		}
+	}
+
+	if( !reserveArray( (void**) &tree->histogram , &tree->histogramCapacity , stats->longest + 1 , sizeof(uint64_t) ) ) {
+		return false;
+	}
+	memset( tree->histogram , 0 , (stats->longest + 1) * sizeof(uint64_t) );
+	stats->histogram = tree->histogram;
+
+	/* a suffix link always points to an older node, so it gets all counts before it is passed on */
+	for( size_t i = tree->nodeCount - 1; i >= 2; i-- ) {
+		struct eertreeNode *node = &tree->nodes[i];
+		tree->nodes[ node->link ].count += node->count;
+		tree->histogram[ node->length ]++;
+
+		/* insert into the short list of the most frequent palindroms */
+		size_t position = stats->topCount;
+		while( position > 0 && moreFrequent( node , &tree->nodes[ stats->top[ position - 1 ] ] ) ) {
+			position--;
+		}
+
+		if( position < EERTREE_TOP ) {
+			const size_t moved = (stats->topCount < EERTREE_TOP ? stats->topCount : EERTREE_TOP - 1) - position;
+			memmove( &stats->top[ position + 1 ] , &stats->top[ position ] , moved * sizeof(uint32_t) );
+			stats->top[ position ] = (uint32_t) i;
+			if( stats->topCount < EERTREE_TOP ) {
+				stats->topCount++;
+			}
+		}
+	}
+
+	return true;
+}
+
+void eertreePalindrom(const struct eertree *tree, const uint32_t node, char *buffer) {
+
+	/* the palindrom is unwrapped from the outside to the center */
+	size_t front = 0;
+	size_t back  = (size_t) tree->nodes[ node ].length;
+
+	for( uint32_t current = node; tree->nodes[ current ].length > 0; current = tree->nodes[ current ].parent ) {
+		buffer[ front++ ] = (char) tree->nodes[ current ].c;
+		buffer[ --back ]  = (char) tree->nodes[ current ].c;
+	}
+}
+
+static inline uint32_t findSuffix(const struct eertree *tree, const unsigned char *chars, const size_t end, uint32_t node) {
+
+	/* the imaginary root always matches, because its palindrom is preceded by the char itself */
+	while( true ) {
+		const long length = tree->nodes[ node ].length;
+		if( (long) end - length - 1 >= 0 && chars[ (long) end - length - 1 ] == chars[ end ] ) {
+			return node;
+		}
+		node = tree->nodes[ node ].link;
+	}
+}
+
+static inline uint32_t findEdge(const struct eertree *tree, const uint32_t node, const unsigned char c) {
+
+	const uint64_t key = (((uint64_t) node << 8) | c) + 1;
+	const size_t mask = tree->edgeCapacity - 1;
+
+	for( size_t slot = (size_t)((key * HASH_KEY) >> 32) & mask; tree->edges[ slot ].key != 0; slot = (slot + 1) & mask ) {
+		if( tree->edges[ slot ].key == key ) {
+			return tree->edges[ slot ].node;
+		}
+	}
+
+	return 0;
+}
+
+static bool addEdge(struct eertree *tree, const uint32_t node, const unsigned char c, const uint32_t target) {
+
+	/* the table is kept at most half full, so the probe sequences stay short */
+	if( 2 * (tree->edgeCount + 1) > tree->edgeCapacity ) {
+		const size_t capacity = tree->edgeCapacity * 2;
+		struct eertreeEdge *edges = (struct eertreeEdge*) calloc( capacity , sizeof(struct eertreeEdge) );
+		if( edges == NULL ) {
+			return false;
+		}
+
+		for( size_t i = 0; i < tree->edgeCapacity; i++ ) {
+			if( tree->edges[i].key == 0 ) {
+				continue;
+			}
+
+			size_t slot = (size_t)((tree->edges[i].key * HASH_KEY) >> 32) & (capacity - 1);
+			while( edges[ slot ].key != 0 ) {
+				slot = (slot + 1) & (capacity - 1);
+			}
+			edges[ slot ] = tree->edges[i];
+		}
+
+		free( tree->edges );
+		tree->edges        = edges;
+		tree->edgeCapacity = capacity;
+	}
+
+	const uint64_t key = (((uint64_t) node << 8) | c) + 1;
+	const size_t mask = tree->edgeCapacity - 1;
+
+	size_t slot = (size_t)((key * HASH_KEY) >> 32) & mask;
+	while( tree->edges[ slot ].key != 0 ) {
+		slot = (slot + 1) & mask;
+	}
+
+	tree->edges[ slot ].key  = key;
+	tree->edges[ slot ].node = target;
+	tree->edgeCount++;
+	return true;
+}
+
+static bool reserveNode(struct eertree *tree) {
+
+	if( tree->nodeCount >= MAX_NODES ) {
+		return false;
+	}
+
+	return reserveArray( (void**) &tree->nodes , &tree->nodeCapacity , tree->nodeCount + 1 , sizeof(struct eertreeNode) );
+}
+
+static bool reserveArray(void **array, size_t *capacity, const size_t count, const size_t size) {
+
+	if( count <= *capacity && *array != NULL ) {
+		return true;
+	}
+
+	/* doubling keeps the copies linear in the total size */
+	size_t grown = *capacity > 0 ? *capacity : 64;
+	while( grown < count ) {
+		if( grown > SIZE_MAX / 2 / size ) {
+			return false;
+		}
+		grown *= 2;
+	}
+
+	void *memory = realloc( *array , grown * size );
+	if( memory == NULL ) {
+		return false;
+	}
+
+	*array    = memory;
+	*capacity = grown;
+	return true;
+}
+
+static inline bool moreFrequent(const struct eertreeNode *a, const struct eertreeNode *b) {
+	/* ties are reported longest first */
+	return a->count > b->count || (a->count == b->count && a->length > b->length);
+}
@@ -0,0 +1,150 @@
+/*
+ * This header file does contain the palindromic tree (eertree) which collects
+ * the statistics of the palindroms in the input. Every node of the tree is a
+ * distinct palindromic substring, so the tree of a string with n chars has at
+ * most n + 2 nodes and it is built in linear time.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#ifndef EERTREE_H
+#define EERTREE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* === Constants === */
+
+/* number of palindroms which are reported as the most frequent ones */
+#define EERTREE_TOP (5)
+
+/* === Type Definitions === */
+
+/*
+ * @brief A distinct palindrom, it is the palindrom of the parent with the char on both sides
+ */
+struct eertreeNode {
+	/* number of chars of the palindrom, -1 for the imaginary root */
+	long length;
+	/* the node of the longest proper palindromic suffix */
+	uint32_t link;
+	/* the node without the first and the last char */
+	uint32_t parent;
+	/* number of occurrences, only complete after eertreeStats */
+	uint64_t count;
+	/* the first and the last char of the palindrom */
+	unsigned char c;
+};
+
+/*
+ * @brief A transition of the tree, it is stored in an open addressing hash table
+ */
+struct eertreeEdge {
+	/* (node << 8 | char) + 1 of the source, 0 for an empty slot */
+	uint64_t key;
+	/* the node of the palindrom with the char on both sides */
+	uint32_t node;
+};
+
+/*
+ * @brief The tree of the palindroms of one or more lines, all memory is reused after a reset
+ */
+struct eertree {
+	bool ignoreSpace;
+	bool ignoreCase;
+
+	/* the arena of the nodes, the first two are the roots */
+	struct eertreeNode *nodes;
+	size_t nodeCount;
+	size_t nodeCapacity;
+
+	/* the transitions, the capacity is a power of two */
+	struct eertreeEdge *edges;
+	size_t edgeCount;
+	size_t edgeCapacity;
+
+	/* the normalized chars of the current line */
+	unsigned char *chars;
+	size_t charCapacity;
+
+	/* number of palindroms per length, filled by eertreeStats */
+	uint64_t *histogram;
+	size_t histogramCapacity;
+};
+
+/*
+ * @brief The statistics of all lines which were added to a tree
+ */
+struct eertreeStats {
+	/* number of distinct palindromic substrings */
+	size_t distinct;
+	/* the histogram has an entry for every length from 0 to longest */
+	const uint64_t *histogram;
+	size_t longest;
+	/* the most frequent palindroms, the most frequent first */
+	uint32_t top[ EERTREE_TOP ];
+	size_t topCount;
+};
+
+/* === Prototypes === */
+
+/*
+ * @brief
+ *	initializes an empty tree, palindromInit must have been called before if
+ *	the case is ignored
+ *
+ * @param tree the tree which should be initialized
+ * @param ignoreSpace true if spaces should be ignored
+ * @param ignoreCase true if the case should be ignored
+ *
+ * @return false if out of memory otherwise true
+ */
+extern bool eertreeInit(struct eertree *tree, const bool ignoreSpace, const bool ignoreCase);
+
+/*
+ * @brief removes all palindroms from the tree but keeps its memory
+ */
+extern void eertreeReset(struct eertree *tree);
+
+/*
+ * @brief frees the memory of the tree
+ */
+extern void eertreeFree(struct eertree *tree);
+
+/*
+ * @brief
+ *	adds all palindromic substrings of the line to the tree. Palindroms do not
+ *	span several lines, but palindroms which occur in several lines are only
+ *	stored once.
+ *
+ * @param tree the tree
+ * @param line the line
+ * @param length the number of chars in line
+ *
+ * @return false if out of memory otherwise true
+ */
+extern bool eertreeAddLine(struct eertree *tree, const char *line, const size_t length);
+
+/*
+ * @brief
+ *	computes the statistics of all lines which were added since the last
+ *	reset. It must only be called once per reset, because the counts of the
+ *	nodes are propagated to their suffixes.
+ *
+ * @param tree the tree
+ * @param stats output parameter for the statistics, it points into the tree
+ *
+ * @return false if out of memory otherwise true
+ */
+extern bool eertreeStats(struct eertree *tree, struct eertreeStats *stats);
+
+/*
+ * @brief writes the normalized chars of the palindrom of a node to the buffer
+ * @param tree the tree
+ * @param node the index of the node
+ * @param buffer the buffer which must be able to hold the length of the node
+ */
+extern void eertreePalindrom(const struct eertree *tree, const uint32_t node, char *buffer);
+
+#endif
@@ -0,0 +1,343 @@
+/*
+ * File mode of ispalindrom. A cursor starts at each end of the file and the
+ * block which contains it is read with pread, the back block is compared
+ * from its end to its start. Without ignoreSpace both cursors move in lockstep,
+ * so the overlap of both blocks is compared at once with the mirrored compare
+ * of palindrom.c. With ignoreSpace the cursors move independently when spaces
+ * are skipped, so spaces at the border of a block do not need special
+ * handling; this loop is specialized for ignoreCase.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "filemode.h"
+#include "palindrom.h"
+
+/* === Constants === */
+
+/* size of the blocks, the blocks start at multiples of it */
+#define BLOCK_SIZE (1024 * 1024)
+
+/* alignment of the buffers (a page) */
+#define BLOCK_ALIGNMENT (4096)
+
+/* === Macros === */
+
+/* the kernel is inlined into the variants so the constant flag removes the branches */
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+
+/* === Type Definitions === */
+
+/*
+ * @brief A block of the file which was read into memory
+ */
+struct block {
+	unsigned char *data;
+	/* offset of the first byte of the block in the file */
+	off_t start;
+	/* number of bytes which were read, 0 if nothing was read yet */
+	size_t length;
+};
+
+/*
+ * @brief
+ *	signature of the comparisons of a file which are specialized for the flags,
+ *	the file is compared from front to behind back
+ *
+ * @return 1 if it is a palindrom, 0 if not and -1 if it could not be read or was interrupted
+ */
+typedef int (*fileCompare)(const int fd, off_t front, off_t back, const off_t size, const palindromMirror mirror,
+                           struct block *head, struct block *tail, volatile sig_atomic_t *running);
+
+/* === Prototypes === */
+
+/*
+ * @brief checks if the file is a palindrom and adds the result to the output
+ * @return EXIT_SUCCESS or EXIT_FAILURE if the file could not be read
+ */
+static int checkWholeFile(const char *path, const bool ignoreSpace, const bool ignoreCase,
+                          struct block *head, struct block *tail,
+                          struct output *out, volatile sig_atomic_t *running);
+
+/*
+ * @brief
+ *	compares the file from both ends, size is the number of bytes of the file
+ *	and the '\n' at its end is not part of the content
+ *
+ * @return 1 if it is a palindrom, 0 if not and -1 if it could not be read or was interrupted
+ */
+static int compareFile(const int fd, const off_t size, const bool ignoreSpace, const bool ignoreCase,
+                       struct block *head, struct block *tail, volatile sig_atomic_t *running);
+
+/*
+ * @brief the comparison without ignoreSpace, the overlap of both blocks is compared with mirror
+ */
+static int compareMirrored(const int fd, off_t front, off_t back, const off_t size, const palindromMirror mirror,
+                           struct block *head, struct block *tail, volatile sig_atomic_t *running);
+
+/*
+ * @brief the comparison with ignoreSpace, it is inlined into compareSpaced and compareSpacedCase
+ */
+static ALWAYS_INLINE int compareSpacedKernel(const int fd, off_t front, off_t back, const off_t size, const bool ignoreCase,
+                                             struct block *head, struct block *tail, volatile sig_atomic_t *running);
+
+static int compareSpaced(const int fd, off_t front, off_t back, const off_t size, const palindromMirror mirror,
+                         struct block *head, struct block *tail, volatile sig_atomic_t *running);
+
+static int compareSpacedCase(const int fd, off_t front, off_t back, const off_t size, const palindromMirror mirror,
+                             struct block *head, struct block *tail, volatile sig_atomic_t *running);
+
+/*
+ * @brief makes sure that head contains front and tail contains back - 1
+ * @return false if a block could not be read otherwise true
+ */
+static bool loadBlocks(const int fd, const off_t front, const off_t back, const off_t size,
+                       struct block *head, struct block *tail);
+
+/*
+ * @brief reads the block which contains the offset into the buffer of the block
+ * @return false if it could not be read otherwise true
+ */
+static bool loadBlock(const int fd, struct block *block, const off_t offset, const off_t size);
+
+/*
+ * @brief checks if the offset is inside of the block
+ */
+static inline bool blockContains(const struct block *block, const off_t offset) {
+	return block->length > 0 && offset >= block->start && offset < block->start + (off_t)block->length;
+}
+
+/* === Implementations === */
+
+int checkWholeFiles(char **files, const int fileCount, const bool ignoreSpace, const bool ignoreCase,
+                    struct output *out, volatile sig_atomic_t *running) {
+
+	struct block head = { NULL , 0 , 0 };
+	struct block tail = { NULL , 0 , 0 };
+
+	void *memory = NULL;
+	if( posix_memalign( &memory , BLOCK_ALIGNMENT , 2 * BLOCK_SIZE ) != 0 ) {
+		( void ) fprintf( stderr , "Error: Out of Memory!\n" );
+		return EXIT_FAILURE;
+	}
+
+	head.data = (unsigned char*) memory;
+	tail.data = head.data + BLOCK_SIZE;
+
+	int ret = EXIT_SUCCESS;
+	for( int i = 0; i < fileCount && *running; i++ ) {
+		if( checkWholeFile( files[i] , ignoreSpace , ignoreCase , &head , &tail , out , running ) == EXIT_FAILURE ) {
+			ret = EXIT_FAILURE;
+		}
+	}
+
+	free( memory );
+	return ret;
+}
+
+static int checkWholeFile(const char *path, const bool ignoreSpace, const bool ignoreCase,
+                          struct block *head, struct block *tail,
+                          struct output *out, volatile sig_atomic_t *running) {
+
+	const int fd = open( path , O_RDONLY );
+	if( fd < 0 ) {
+		( void ) fprintf( stderr , "Error: Unable to open %s: %s\n" , path , strerror( errno ) );
+		return EXIT_FAILURE;
+	}
+
+	struct stat info;
+	if( fstat( fd , &info ) < 0 ) {
+		( void ) fprintf( stderr , "Error: Unable to stat %s: %s\n" , path , strerror( errno ) );
+		( void ) close( fd );
+		return EXIT_FAILURE;
+	}
+
+	head->length = 0;
+	tail->length = 0;
+
+	const int result = compareFile( fd , info.st_size , ignoreSpace , ignoreCase , head , tail , running );
+	( void ) close( fd );
+
+	if( result < 0 ) {
+		/* an interrupted check does not have a result */
+		if( !*running ) {
+			return EXIT_SUCCESS;
+		}
+
+		( void ) fprintf( stderr , "Error: Unable to read %s: %s\n" , path , strerror( errno ) );
+		return EXIT_FAILURE;
+	}
+
+	if( !outputResult( out , path , strlen( path ) , result == 1 ) ) {
+		( void ) fprintf( stderr , "Error: Unable to write the results: %s\n" , strerror( errno ) );
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+static int compareFile(const int fd, const off_t size, const bool ignoreSpace, const bool ignoreCase,
+                       struct block *head, struct block *tail, volatile sig_atomic_t *running) {
+
+	/* front is the next byte from the front, back is behind the next byte from the back */
+	off_t front = 0;
+	off_t back  = size;
+
+	/* the '\n' which terminates the last line is not part of the content */
+	if( back > 0 ) {
+		if( !loadBlock( fd , tail , back - 1 , size ) ) {
+			return -1;
+		}
+		if( tail->data[ back - 1 - tail->start ] == '\n' ) {
+			back--;
+		}
+	}
+
+	const fileCompare compare = !ignoreSpace ? compareMirrored : ignoreCase ? compareSpacedCase : compareSpaced;
+	return compare( fd , front , back , size , palindromMirrorSelect( ignoreCase ) , head , tail , running );
+}
+
+static int compareMirrored(const int fd, off_t front, off_t back, const off_t size, const palindromMirror mirror,
+                           struct block *head, struct block *tail, volatile sig_atomic_t *running) {
+
+	/* the middle byte of an odd length does not have to be compared */
+	while( back - front > 1 ) {
+
+		if( !*running ) {
+			return -1;
+		}
+
+		if( !loadBlocks( fd , front , back , size , head , tail ) ) {
+			return -1;
+		}
+
+		/* compare until one of the cursors leaves its block or both meet */
+		off_t count = (back - front) / 2;
+		if( count > head->start + (off_t)head->length - front ) {
+			count = head->start + (off_t)head->length - front;
+		}
+		if( count > back - tail->start ) {
+			count = back - tail->start;
+		}
+
+		const char *first = (const char*)head->data + (front - head->start);
+		const char *last  = (const char*)tail->data + (back - count - tail->start);
+		if( !mirror( first , last , (size_t)count ) ) {
+			return 0;
+		}
+
+		front += count;
+		back  -= count;
+	}
+
+	return 1;
+}
+
+static ALWAYS_INLINE int compareSpacedKernel(const int fd, off_t front, off_t back, const off_t size, const bool ignoreCase,
+                                             struct block *head, struct block *tail, volatile sig_atomic_t *running) {
+
+	while( front < back ) {
+
+		if( !*running ) {
+			return -1;
+		}
+
+		if( !loadBlocks( fd , front , back , size , head , tail ) ) {
+			return -1;
+		}
+
+		/* compare until one of the cursors leaves its block */
+		const unsigned char *first    = head->data + (front - head->start);
+		const unsigned char *firstEnd = head->data + head->length;
+		const unsigned char *last     = tail->data + (back - tail->start);
+		const unsigned char *lastEnd  = tail->data;
+
+		while( front < back && first < firstEnd && last > lastEnd ) {
+			unsigned char a = *first;
+			unsigned char b = *(last - 1);
+
+			if( a == SPACE ) {
+				first++;
+				front++;
+				continue;
+			}
+			if( b == SPACE ) {
+				last--;
+				back--;
+				continue;
+			}
+
+			if( ignoreCase ) {
+				a = palindromLowerTable[ a ];
+				b = palindromLowerTable[ b ];
+			}
+
+			if( a != b ) {
+				return 0;
+			}
+
+			first++;
+			front++;
+			last--;
+			back--;
+		}
+	}
+
+	return 1;
+}
+
+static int compareSpaced(const int fd, off_t front, off_t back, const off_t size, const palindromMirror mirror,
+                         struct block *head, struct block *tail, volatile sig_atomic_t *running) {
+	return compareSpacedKernel( fd , front , back , size , false , head , tail , running );
+}
+
+static int compareSpacedCase(const int fd, off_t front, off_t back, const off_t size, const palindromMirror mirror,
+                             struct block *head, struct block *tail, volatile sig_atomic_t *running) {
+	return compareSpacedKernel( fd , front , back , size , true , head , tail , running );
+}
+
+static bool loadBlocks(const int fd, const off_t front, const off_t back, const off_t size,
+                       struct block *head, struct block *tail) {
+
+	if( !blockContains( head , front ) && !loadBlock( fd , head , front , size ) ) {
+		return false;
+	}
+
+	return blockContains( tail , back - 1 ) || loadBlock( fd , tail , back - 1 , size );
+}
+
+static bool loadBlock(const int fd, struct block *block, const off_t offset, const off_t size) {
+
+	const off_t start = offset - offset % BLOCK_SIZE;
+	const size_t length = (size_t)( size - start < BLOCK_SIZE ? size - start : BLOCK_SIZE );
+
+	size_t done = 0;
+	while( done < length ) {
+		const ssize_t count = pread( fd , block->data + done , length - done , start + (off_t)done );
+		if( count < 0 && errno == EINTR ) {
+			continue;
+		}
+		if( count <= 0 ) {
+			/* the file was truncated while it was read */
+			if( count == 0 ) {
+				errno = EIO;
+			}
+			block->length = 0;
+			return false;
+		}
+		done += (size_t)count;
+	}
+
+	block->start  = start;
+	block->length = length;
+	return true;
+}
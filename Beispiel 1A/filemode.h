@@ -0,0 +1,40 @@
+/*
+ * This header file does contain the file mode of ispalindrom which checks if
+ * a whole file is a palindrom. The file is read with pread in blocks from the
+ * front and from the back, so files of any size are checked with two blocks
+ * of memory.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#ifndef FILEMODE_H
+#define FILEMODE_H
+
+#include <stdbool.h>
+#include <signal.h>
+
+#include "output.h"
+
+/* === Prototypes === */
+
+/*
+ * @brief
+ *	checks if the content of each file is a palindrom and adds a result per
+ *	file (named by its path) to the output. A single '\n' at the end of a file
+ *	is not part of the content. Errors of single files are printed to stderr
+ *	and the remaining files are still checked. palindromInit must have been
+ *	called before.
+ *
+ * @param files the paths of the files which should be checked
+ * @param fileCount number of paths in files
+ * @param ignoreSpace true if spaces should be ignored
+ * @param ignoreCase true if the case should be ignored
+ * @param out the output to which the results are added
+ * @param running the files are only checked as long as this flag is true
+ *
+ * @return EXIT_SUCCESS if all files could be checked otherwise EXIT_FAILURE
+ */
+extern int checkWholeFiles(char **files, const int fileCount, const bool ignoreSpace, const bool ignoreCase,
+                           struct output *out, volatile sig_atomic_t *running);
+
+#endif
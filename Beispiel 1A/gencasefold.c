@@ -0,0 +1,119 @@
+/*
+ * Generates casefold_table.h, the lookup table which is used by the UTF-8
+ * mode of ispalindrom to ignore the case of code points. The mapping is the
+ * lower case of the upper case of every code point in the C.UTF-8 locale,
+ * so all case variants of a letter are mapped to the same code point.
+ *
+ * The table has two levels: the code point without its lowest bits selects
+ * a page and the page contains the difference to the folded code point for
+ * the lowest bits. Equal pages are only stored once, most of them are empty.
+ *
+ * Usage: gencasefold > casefold_table.h
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <locale.h>
+#include <wctype.h>
+
+/* === Constants === */
+
+/* code points from here on are not folded */
+#define CASEFOLD_LIMIT (0x20000)
+/* number of code points per page is 1 << CASEFOLD_SHIFT */
+#define CASEFOLD_SHIFT (7)
+#define CASEFOLD_PAGE_SIZE (1 << CASEFOLD_SHIFT)
+#define CASEFOLD_BLOCKS (CASEFOLD_LIMIT >> CASEFOLD_SHIFT)
+/* the index of a page must fit into a uint8_t */
+#define MAX_PAGES (256)
+
+/* === Global Variables === */
+
+static int32_t pages[ MAX_PAGES ][ CASEFOLD_PAGE_SIZE ];
+static uint8_t blockIndex[ CASEFOLD_BLOCKS ];
+
+/*
+ * @brief Entry point of the generator
+ * @return EXIT_SUCCESS or EXIT_FAILURE if the locale is not available
+ */
+int main(void) {
+
+	if( setlocale( LC_CTYPE , "C.UTF-8" ) == NULL ) {
+		( void ) fprintf( stderr , "Error: the locale C.UTF-8 is not available!\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	/* the first page is the page without any differences */
+	int pageCount = 1;
+	memset( pages , 0 , sizeof(pages) );
+
+	for( int block = 0; block < CASEFOLD_BLOCKS; block++ ) {
+		int32_t page[ CASEFOLD_PAGE_SIZE ];
+
+		for( int i = 0; i < CASEFOLD_PAGE_SIZE; i++ ) {
+			const wint_t codePoint = (wint_t)((block << CASEFOLD_SHIFT) | i);
+			const wint_t folded    = towlower( towupper( codePoint ) );
+			page[i] = (int32_t)folded - (int32_t)codePoint;
+		}
+
+		/* reuse an equal page if there is one */
+		int found = -1;
+		for( int p = 0; p < pageCount && found < 0; p++ ) {
+			if( memcmp( pages[p] , page , sizeof(page) ) == 0 ) {
+				found = p;
+			}
+		}
+
+		if( found < 0 ) {
+			if( pageCount == MAX_PAGES ) {
+				( void ) fprintf( stderr , "Error: too many different pages!\n" );
+				exit( EXIT_FAILURE );
+			}
+
+			found = pageCount++;
+			memcpy( pages[ found ] , page , sizeof(page) );
+		}
+
+		blockIndex[ block ] = (uint8_t)found;
+	}
+
+	( void ) printf( "/*\n"
+	                 " * Case folding table for the UTF-8 mode of ispalindrom.\n"
+	                 " * This file is generated by gencasefold, do not edit it!\n"
+	                 " */\n\n"
+	                 "#ifndef CASEFOLD_TABLE_H\n"
+	                 "#define CASEFOLD_TABLE_H\n\n"
+	                 "#include <stdint.h>\n\n"
+	                 "#define CASEFOLD_LIMIT (0x%X)\n"
+	                 "#define CASEFOLD_SHIFT (%d)\n"
+	                 "#define CASEFOLD_PAGE_SIZE (%d)\n"
+	                 "#define CASEFOLD_BLOCKS (%d)\n"
+	                 "#define CASEFOLD_PAGES (%d)\n\n"
+	                 , CASEFOLD_LIMIT , CASEFOLD_SHIFT , CASEFOLD_PAGE_SIZE , CASEFOLD_BLOCKS , pageCount );
+
+	( void ) printf( "/* page of every block of code points */\n"
+	                 "static const uint8_t caseFoldIndex[ CASEFOLD_BLOCKS ] = {" );
+	for( int block = 0; block < CASEFOLD_BLOCKS; block++ ) {
+		( void ) printf( "%s%d%s" , block % 16 == 0 ? "\n\t" : "" , blockIndex[ block ] ,
+		                 block + 1 < CASEFOLD_BLOCKS ? ", " : "\n" );
+	}
+	( void ) printf( "};\n\n" );
+
+	( void ) printf( "/* difference to the folded code point */\n"
+	                 "static const int32_t caseFoldPages[ CASEFOLD_PAGES ][ CASEFOLD_PAGE_SIZE ] = {\n" );
+	for( int p = 0; p < pageCount; p++ ) {
+		( void ) printf( "\t{" );
+		for( int i = 0; i < CASEFOLD_PAGE_SIZE; i++ ) {
+			( void ) printf( "%s%d%s" , i % 16 == 0 ? "\n\t\t" : "" , pages[p][i] ,
+			                 i + 1 < CASEFOLD_PAGE_SIZE ? ", " : "\n" );
+		}
+		( void ) printf( "\t}%s\n" , p + 1 < pageCount ? "," : "" );
+	}
+	( void ) printf( "};\n\n#endif\n" );
+
+	return EXIT_SUCCESS;
+}
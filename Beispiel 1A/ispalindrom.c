@@ -11,14 +11,118 @@
 #include <string.h>
 #include <ctype.h>
 #include <signal.h>
+#include <stdint.h>
+#include <errno.h>
+#include <limits.h>
+#include <getopt.h>
+#include <sys/stat.h>
+
+#include "palindrom.h"
+#include "batch.h"
+#include "output.h"
+#include "utf8.h"
+#include "rollhash.h"
+#include "longest.h"
+#include "filemode.h"
+#include "pipeline.h"
+#include "cache.h"
+#include "approx.h"
+#include "eertree.h"
+#include "parallel.h"
 
 /* === Constants === */
 
 #define FLAG_IGNORE_SPACE ('s')
 #define FLAG_IGNORE_CASE  ('i')
+#define FLAG_LONG_LINES   ('l')
+#define FLAG_BATCH_FILES  ('f')
+#define FLAG_THREADS      ('j')
+#define FLAG_OUTPUT       ('o')
+#define FLAG_UTF8         ('u')
+#define FLAG_ROLLING_HASH ('r')
+#define FLAG_LONGEST      ('m')
+#define FLAG_CACHE        ('c')
+#define FLAG_MAX_EDITS    ('k')
+#define FLAG_STATS        ('e')
+#define OPTSTRING ("silfurmj:o:c:k:e:")
+/* long options do not have a char, so they get values behind all chars */
+#define OPTION_FILE_MODE (256)
 #define END_OF_OPTS (-1)
 #define MAX_INPUT_LEN (40)
-#define SPACE (' ')
+/* the largest cache which may be requested with -c (64 MiB of entries) */
+#define MAX_CACHE_ENTRIES (4L * 1024 * 1024)
+#define STRINGIFY(x) #x
+#define TO_STRING(x) STRINGIFY(x)
+#define TOO_LONG_MESSAGE ("Only up to " TO_STRING(MAX_INPUT_LEN) " Characters are supported!\n")
+
+/* initial size of the line buffer, it grows by doubling if a line does not fit */
+#define LINE_BUFFER_INITIAL (64)
+/* a line buffer larger than this is shrunk again once it only holds short lines */
+#define LINE_BUFFER_SHRINK_LIMIT (1024 * 1024)
+
+/* scopes of the palindrom statistics */
+#define STATS_NONE (0)
+#define STATS_LINE (1)
+#define STATS_STREAM (2)
+/* the label of the statistics of the whole input in the text format */
+#define STATS_STREAM_LABEL ("input")
+
+/* return values of readLine */
+#define LINE_READ (0)
+#define LINE_TOO_LONG (1)
+#define LINE_END_OF_INPUT (2)
+#define LINE_OUT_OF_MEMORY (3)
+
+/* === Type Definitions === */
+
+/*
+ * @brief The options which were parsed from the command line
+ */
+struct options {
+	/* true if spaces should be ignored */
+	bool ignoreSpace;
+	/* true if the case should be ignored */
+	bool ignoreCase;
+	/* true if lines of any length are accepted */
+	bool longLines;
+	/* true if the lines of the files are checked instead of stdin */
+	bool batchFiles;
+	/* true if the input is compared by UTF-8 code points instead of bytes */
+	bool utf8;
+	/* true if the lines are checked with hashes without storing them */
+	bool rollingHash;
+	/* true if the longest palindrom of every line is searched */
+	bool longest;
+	/* true if every file is checked as a single string */
+	bool wholeFiles;
+	/* number of worker threads, 0 if it was not specified */
+	long threads;
+	/* number of edits which are allowed in the approximate mode, -1 for the exact check */
+	long maxEdits;
+	/* number of entries of the result cache (per thread), 0 without cache */
+	long cacheEntries;
+	/* STATS_LINE or STATS_STREAM if the statistics of the palindroms are collected */
+	int stats;
+	/* the format of the results, -1 if it was not specified */
+	int format;
+	/* the palindrom check which is specialized for the flags */
+	palindromVariant check;
+	/* the files which are checked in the batch mode */
+	char **files;
+	int fileCount;
+};
+
+/*
+ * @brief A growable buffer which does hold a single line of the input
+ */
+struct lineBuffer {
+	/* the null terminated content of the line without the '\n' */
+	char *data;
+	/* number of chars in data (without the terminating null char) */
+	size_t length;
+	/* number of bytes which are allocated for data */
+	size_t capacity;
+};
 
 /* === Global Variables === */
 
@@ -38,28 +142,91 @@ static void printUsage(const char* const command);
 
 /*
  * @brief 
- * 	parses the program agruments and sets the fales ignoreSpace and ignoreCase
+ * 	parses the program agruments and sets the fields of options
  *      this function may print to stderr if an error occurs!
  *
  * @param argc the argument count from the commmand line
  * @param argv the argument strings from the command line
- * @param ignoreSpace a pointer to a boolean which is set to true if ignoreSpace flag was read
- * @param ignoreCase a pointer to a boolean which is set to true if ignoreCase flag was read
+ * @param options the structure in which the parsed options are stored
  *
  * @return EXIT_SUCCESS if parsing was successfull otherwise EXIT_FAILURE
  */
-static int parseArguments(const int argc,char** argv,bool *ignoreSpace,bool *ignoreCase);
+static int parseArguments(const int argc,char** argv,struct options *options);
+
+/*
+ * @brief sets a flag and fails if it was already set before
+ * @param flag the flag which should be set
+ * @param opt the option char of the flag
+ * @param command The name of the command (should be argv[0])
+ * @return EXIT_SUCCESS if the flag was not set before otherwise EXIT_FAILURE
+ */
+static int setFlagOnce(bool *flag, const int opt, const char* const command);
+
+/*
+ * @brief reads the lines from stdin and checks if they are palindroms until EOF or SIGINT
+ * @param options the parsed options
+ * @param cache the settings of the result cache or NULL if the results are not cached
+ * @param out the output to which the results are added
+ * @return EXIT_SUCCESS or EXIT_FAILURE
+ */
+static int checkInput(const struct options *options, const struct cacheConfig *cache, struct output *out);
+
+/*
+ * @brief adds the statistics of the palindroms in the tree to the output
+ * @param tree the tree with the palindroms of the line or of the whole input
+ * @param label the line or the name of the input
+ * @param length the number of chars in label
+ * @param out the output to which the statistics are added
+ * @return EXIT_SUCCESS or EXIT_FAILURE
+ */
+static int reportStats(struct eertree *tree, const char *label, const size_t length, struct output *out);
 
 /*
- * @brief this function does check of the give string (input) is a palindrom or not
+ * @brief parses the scope of the statistics
+ * @param name "line" or "stream"
+ * @return STATS_LINE, STATS_STREAM or STATS_NONE if the name is unknown
+ */
+static int statsFromName(const char *name);
+
+/*
+ * @brief parses a number of the command line which must be in [min, max]
+ * @param text the argument of the option
+ * @param min the smallest allowed number
+ * @param max the largest allowed number
+ * @param number output parameter for the number
+ * @return true if the number is valid otherwise false
+ */
+static bool parseNumber(const char *text, const long min, const long max, long *number);
+
+/*
+ * @brief
+ *	reads a single line from the stream into the line buffer, the buffer is grown
+ *	as needed. Lines longer than maxLength are consumed completely but not stored.
  *
- * @param input a null terminated string which should be checked if it's a palindrom
- * @param ignoreSpace true if spaces should be ignored
- * @param ignoreCase true if the case should be ignored
+ * @param stream the stream from which the line should be read
+ * @param line the line buffer in which the line is stored (without the '\n')
+ * @param maxLength maximum number of chars of a line or 0 if the length is unbounded
  *
- * @return true if string is palindrom otherwise not
+ * @return LINE_READ, LINE_TOO_LONG, LINE_END_OF_INPUT or LINE_OUT_OF_MEMORY
+ */
+static int readLine(FILE *stream, struct lineBuffer *line, const size_t maxLength);
+
+/*
+ * @brief grows the line buffer so that it can hold at least one more char and the null char
+ * @param line the line buffer which should be grown
+ * @return true if the buffer could be grown otherwise false
+ */
+static bool growLineBuffer(struct lineBuffer *line);
+
+/*
+ * @brief returns the maximum number of chars of a line or 0 if the length is unbounded
+ */
+static size_t maxLineLength(const struct options *options);
+
+/*
+ * @brief checks if the file descriptor is a pipe
  */
-static bool isStringPalindrom(const char* input, const bool ignoreSpace, const bool ignoreCase);
+static bool isPipe(const int fd);
 
 /**
  * @brief handles the exit signals from the console 
@@ -78,169 +245,482 @@ static void signalHandler( int signal );
 int main( int argc , char** argv ) {
 	
 	/* these flags might get set by the parseArguments function */
-	bool ignoreSpace = false;
-	bool ignoreCase  = false;
+	struct options options;
+	options.ignoreSpace = false;
+	options.ignoreCase  = false;
+	options.longLines   = false;
+	options.batchFiles  = false;
+	options.utf8        = false;
+	options.rollingHash = false;
+	options.longest     = false;
+	options.wholeFiles  = false;
+	options.threads     = 0;
+	options.cacheEntries = 0;
+	options.maxEdits    = -1;
+	options.stats       = STATS_NONE;
+	options.format      = -1;
+	options.files       = NULL;
+	options.fileCount   = 0;
+
+
+	if( parseArguments( argc ,argv , &options ) == EXIT_FAILURE ) {
+		exit( EXIT_FAILURE );
+	}
 
+	/* use one worker per cpu if the number of threads was not specified */
+	if( options.threads == 0 ) {
+		options.threads = sysconf( _SC_NPROCESSORS_ONLN );
+		if( options.threads < 1 ) {
+			options.threads = 1;
+		}
+	}
 
-	if( parseArguments( argc ,argv , &ignoreSpace , &ignoreCase ) == EXIT_FAILURE ) {
-		exit( EXIT_FAILURE );
+	/* select the fastest palindrom check for this cpu and the flags */
+	palindromInit();
+	if( options.utf8 ) {
+		options.check = utf8Select( options.ignoreSpace , options.ignoreCase );
+	} else if( options.maxEdits >= 0 ) {
+		options.check = approxSelect( options.ignoreSpace , options.ignoreCase , (int) options.maxEdits );
+	} else {
+		options.check = palindromSelect( options.ignoreSpace , options.ignoreCase );
 	}
 
 	/* install signal handler (needed for endless input) */
 	struct sigaction sigact;
 	sigact.sa_handler = signalHandler;
+	sigact.sa_flags   = 0;
 	sigemptyset( &sigact.sa_mask );
 
 	if( sigaction( SIGINT , &sigact , NULL ) == -1 ) {
 		( void ) fprintf( stderr , "Error: Unable to install SIGINT Handler!\n" );
 		exit( EXIT_FAILURE );
 	}
-	
 
-	/* reserve memory for the string */
-	char* input = (char*) calloc( MAX_INPUT_LEN + 1 + 1, sizeof(char) );
-	if( input == NULL ) {
+	/* the results are collected and written in large blocks */
+	struct output out;
+	if( !outputInit( &out , STDOUT_FILENO , options.format == -1 ? OUTPUT_TEXT : options.format ) ) {
 		( void ) fprintf( stderr , "Error: Out of Memory!\n" );
 		exit( EXIT_FAILURE );
 	}
 
+	/* somebody is typing, so every answer is written immediately */
+	out.flushEachLine = isatty( STDIN_FILENO );
+
+	/* the UTF-8 check also ignores other spaces, so the spaces must stay in the key of the cache */
+	struct cacheStats cacheStats = { 0 , 0 , 0 };
+	struct cacheConfig cacheConfig;
+	cacheConfig.entries     = (size_t) options.cacheEntries;
+	cacheConfig.ignoreSpace = options.ignoreSpace && !options.utf8;
+	cacheConfig.ignoreCase  = options.ignoreCase;
+	cacheConfig.stats       = &cacheStats;
+	const struct cacheConfig *cache = options.cacheEntries > 0 ? &cacheConfig : NULL;
+
+	int ret = EXIT_SUCCESS;
+	if( options.wholeFiles ) {
+		ret = checkWholeFiles( options.files , options.fileCount , options.ignoreSpace , options.ignoreCase ,
+		                       &out , &readFromInput );
+	} else if( options.rollingHash ) {
+		ret = checkStream( STDIN_FILENO , options.ignoreSpace , options.ignoreCase , &out , &readFromInput );
+	} else if( options.batchFiles ) {
+		ret = checkFiles( options.files , options.fileCount , options.check , maxLineLength( &options ) , TOO_LONG_MESSAGE ,
+		                  options.threads , &out , &readFromInput , cache );
+	} else if( !options.longest && options.stats == STATS_NONE && isPipe( STDIN_FILENO ) ) {
+		/* reading, checking and writing overlap if the input comes from another process */
+		ret = checkPipeline( STDIN_FILENO , options.check , maxLineLength( &options ) , TOO_LONG_MESSAGE ,
+		                     options.threads , &out , &readFromInput , cache );
+	} else {
+		/* the lines are checked by this thread alone, so the threads can split a very long line instead */
+		if( !options.utf8 && options.maxEdits < 0 ) {
+			options.check = parallelSelect( options.ignoreSpace , options.ignoreCase , options.threads );
+		}
+		ret = checkInput( &options , cache , &out );
+	}
+
+	if( !outputClose( &out ) ) {
+		( void ) fprintf( stderr , "Error: Unable to write the results!\n" );
+		ret = EXIT_FAILURE;
+	}
+
+	if( cache != NULL ) {
+		( void ) fprintf( stderr , "Cache: %llu hits, %llu misses, %llu evictions\n" ,
+		                  (unsigned long long) cacheStats.hits , (unsigned long long) cacheStats.misses ,
+		                  (unsigned long long) cacheStats.evictions );
+	}
+
+	return ret;
+}
+
+static int checkInput(const struct options *options, const struct cacheConfig *cache, struct output *out) {
+
+	/* reserve memory for the string, in the long line mode it grows as needed */
+	struct lineBuffer line;
+	line.length   = 0;
+	line.capacity = maxLineLength( options ) == 0 ? LINE_BUFFER_INITIAL : MAX_INPUT_LEN + 1;
+	line.data     = (char*) calloc( line.capacity , sizeof(char) );
+	if( line.data == NULL ) {
+		( void ) fprintf( stderr , "Error: Out of Memory!\n" );
+		return EXIT_FAILURE;
+	}
+
+
+	struct longestBuffers longest;
+	longestInit( &longest );
+
+	struct eertree tree;
+	if( options->stats != STATS_NONE && !eertreeInit( &tree , options->ignoreSpace , options->ignoreCase ) ) {
+		( void ) fprintf( stderr , "Error: Out of Memory!\n" );
+		free( line.data );
+		return EXIT_FAILURE;
+	}
+
+	/* without memory for the cache the lines are just checked */
+	struct palindromCache results;
+	const bool cached = cache != NULL && cacheInit( &results , cache , options->check );
 
 	/* enter endless loop until CTRL-C or something else happends */
+	int ret = EXIT_SUCCESS;
 	while( readFromInput ) {
-		( void ) memset( input , 0 , sizeof(char) ); // Clear memory 
-		
-
-		/* read chars from stdin */
-		int inputChar = EOF;
-		int currentInput = 0;
-		do {
-			inputChar = fgetc( stdin );
-			if( inputChar == EOF ) break;
 
-			input[ currentInput ] = (char)inputChar;
-			currentInput++;
+		const int status = readLine( stdin , &line , maxLineLength( options ) );
 
-		} while( inputChar != '\n' && currentInput <= MAX_INPUT_LEN );
+		/* Ctrl-D or the input was interrupted by a signal */
+		if( status == LINE_END_OF_INPUT ) {
+			break;
+		}
 
-		
-		/* check if fgetc did not even read a single char from stdin -> Ctrl-D ? */
-		if( currentInput <= 0 && inputChar == EOF ) {
+		if( status == LINE_OUT_OF_MEMORY ) {
+			( void ) fprintf( stderr , "Error: Out of Memory!\n" );
+			ret = EXIT_FAILURE;
 			break;
 		}
 
-		/* strip remaining \n from string */
-		input[ --currentInput ] = '\0';
-		
+		/* too long lines have already been skipped, they and empty lines are not checked
+		   but still get a result (except for the statistics of the whole stream) */
+		if( status == LINE_TOO_LONG || line.length == 0 ) {
+			const char *message = status == LINE_TOO_LONG ? TOO_LONG_MESSAGE : NULL;
+			const bool written = options->stats == STATS_STREAM ? message == NULL || outputMessage( out , message )
+			                                                    : outputSkipped( out , message );
+			if( !written ) {
+				ret = EXIT_FAILURE;
+				break;
+			}
+			continue;
+		}
 
-		/* check if we had to use the overflow char */
-		if( currentInput >= MAX_INPUT_LEN ) {
-			( void ) fprintf( stdout , "Only up to 40 Characters are supported!" );
+		if( options->longest ) {
+			struct longestResult result;
+			if( !longestPalindrom( &longest , line.data , line.length , options->ignoreSpace , options->ignoreCase , &result ) ) {
+				( void ) fprintf( stderr , "Error: Out of Memory!\n" );
+				ret = EXIT_FAILURE;
+				break;
+			}
+
+			if( !outputLongest( out , line.data , line.length , result.offset , result.length ) ) {
+				ret = EXIT_FAILURE;
+				break;
+			}
 			continue;
 		}
-		
-		/* fgets did read a 0 char string ... will ignore it */
-		if( currentInput == 0 ) {
+
+		if( options->stats != STATS_NONE ) {
+			/* the tree of the whole input keeps growing until the end */
+			if( options->stats == STATS_LINE ) {
+				eertreeReset( &tree );
+			}
+
+			if( !eertreeAddLine( &tree , line.data , line.length ) ) {
+				( void ) fprintf( stderr , "Error: Out of Memory!\n" );
+				ret = EXIT_FAILURE;
+				break;
+			}
+
+			if( options->stats == STATS_LINE && (ret = reportStats( &tree , line.data , line.length , out )) == EXIT_FAILURE ) {
+				break;
+			}
 			continue;
 		}
 
 		/* check if input is a palindrom */
-		if( isStringPalindrom( (const char*)input , ignoreSpace , ignoreCase ) ) {
-			( void ) fprintf( stdout , "%s is a palindrom\n" , input );
-		} else {
-			( void ) fprintf( stdout , "%s isn't a palindrom\n" , input );
+		const bool palindrom = cached ? cacheCheck( &results , line.data , line.length )
+		                              : options->check( (const char*)line.data , line.length );
+		if( !outputResult( out , line.data , line.length , palindrom ) ) {
+			ret = EXIT_FAILURE;
+			break;
 		}
 		
 	}
 
+	/* the statistics of the input are also reported if it was interrupted */
+	if( options->stats == STATS_STREAM && ret == EXIT_SUCCESS ) {
+		ret = reportStats( &tree , STATS_STREAM_LABEL , strlen( STATS_STREAM_LABEL ) , out );
+	}
+
 	/* clean up */
-	if( input != NULL ) {
-		free( input );
-		input = NULL;
+	if( options->stats != STATS_NONE ) {
+		eertreeFree( &tree );
+	}
+	longestFree( &longest );
+	if( cached ) {
+		cacheFree( &results );
+	}
+	if( line.data != NULL ) {
+		free( line.data );
+		line.data = NULL;
 	}
 
-	return EXIT_SUCCESS;
+	return ret;
 }
 
+static int reportStats(struct eertree *tree, const char *label, const size_t length, struct output *out) {
 
-static bool isStringPalindrom(const char* input, bool ignoreSpace, bool ignoreCase) {
+	struct eertreeStats stats;
+	if( !eertreeStats( tree , &stats ) ) {
+		( void ) fprintf( stderr , "Error: Out of Memory!\n" );
+		return EXIT_FAILURE;
+	}
 
-	int length = strlen( input ) - 1;
-	int offsetBegin = 0;
-	int offsetEnd   = 0;
-	
-	/* Loop halve of the string and compare these positions */
-	for( int i=0; i<=length/2 ; i++ ) {
-
-		/* due ignoreSpaces flag there might be a offset due spaces */
-		char begin = input[ i+offsetBegin      ];
-		char end   = input[ length-i-offsetEnd ];
-
-		/* do check with spaces -> set offset */
-		if( ignoreSpace && begin == SPACE ) {
-			 i--;	
-			 offsetBegin++;
-			 continue;
+	return outputStats( out , label , length , tree , &stats ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int readLine(FILE *stream, struct lineBuffer *line, const size_t maxLength) {
+
+	/* a single huge line should not pin its memory for the rest of the input */
+	if( line->capacity > LINE_BUFFER_SHRINK_LIMIT && line->length < line->capacity / 4 ) {
+		char *smaller = (char*) realloc( line->data , LINE_BUFFER_SHRINK_LIMIT );
+		if( smaller != NULL ) {
+			line->data     = smaller;
+			line->capacity = LINE_BUFFER_SHRINK_LIMIT;
 		}
-		if( ignoreSpace && end == SPACE ) {
-			i--;
-			offsetEnd++;
+	}
+
+	line->length  = 0;
+	line->data[0] = '\0';
+
+	/* read chars from the stream until the end of the line */
+	bool tooLong  = false;
+	int inputChar = EOF;
+	while( (inputChar = getc_unlocked( stream )) != EOF && inputChar != '\n' ) {
+
+		/* too long lines are consumed to the end but not stored */
+		if( tooLong || (maxLength > 0 && line->length >= maxLength) ) {
+			tooLong = true;
 			continue;
 		}
-		
-		/* convert to lower if case should be ignored*/
-		if( ignoreCase ) {
-			begin = tolower( begin );
-			end   = tolower( end );
+
+		if( line->length + 1 >= line->capacity && !growLineBuffer( line ) ) {
+			return LINE_OUT_OF_MEMORY;
 		}
 
+		line->data[ line->length++ ] = (char)inputChar;
+	}
+
+	line->data[ line->length ] = '\0';
 
-		/* compare and return false if chars do not match */
-		if( begin != end ) {
-			return false;
-		}
+	/* check if not even a single char was read -> Ctrl-D or a signal? */
+	if( inputChar == EOF && line->length == 0 && !tooLong ) {
+		return LINE_END_OF_INPUT;
+	}
 
+	return tooLong ? LINE_TOO_LONG : LINE_READ;
+}
+
+static bool growLineBuffer(struct lineBuffer *line) {
+
+	/* doubling keeps the overhead per byte constant */
+	if( line->capacity > SIZE_MAX / 2 ) {
+		return false;
 	}
 
+	const size_t capacity = line->capacity * 2;
+	char *data = (char*) realloc( line->data , capacity );
+	if( data == NULL ) {
+		return false;
+	}
+
+	line->data     = data;
+	line->capacity = capacity;
 	return true;
 }
 
+
 static void printUsage(const char* const command) {
-	( void ) fprintf( stderr , "Usage: %s [-%c] [-%c]\n"
+	( void ) fprintf( stderr , "Usage: %s [-%c] [-%c] [-%c] [-%c] [-%c] [-%c] [-%c threads] [-%c entries] [-%c edits] [-%c scope] [-%c format] [-%c file... | --file-mode file...]\n"
 				   "-%c\t\tIgnores spaces in the input\n"
 				   "-%c\t\tIgnores character case in the input\n"
-				   , command , FLAG_IGNORE_CASE , FLAG_IGNORE_SPACE
+				   "-%c\t\tAccepts lines of any length instead of only %d characters\n"
+				   "-%c\t\tCompares UTF-8 characters instead of bytes\n"
+				   "-%c\t\tReports the offset and length of the longest palindrom in every line\n"
+				   "-%c\t\tChecks lines of any length with hashes without storing them (lines are reported by number)\n"
+				   "-%c\t\tNumber of worker threads, without -%c or a pipe they check a single very long line (default: number of cpus)\n"
+				   "-%c\t\tCaches the results of up to this many distinct lines (per thread)\n"
+				   "-%c\t\tAccepts lines which are palindroms after up to this many edits (0 - %d), lines of any length are accepted\n"
+				   "-%c\t\tReports the distinct palindroms, their lengths and the most frequent ones per line or of the whole stream\n"
+				   "-%c\t\tFormat of the results: text (default), digits (0 / 1 per line) or bitmap (1 bit per line),\n"
+				   "\t\tthere is one result per input line: empty and too long lines give - or a 0 bit\n"
+				   "-%c\t\tChecks all lines of the files instead of stdin\n"
+				   "--file-mode\tChecks if the whole content of each file is a palindrom\n"
+				   , command , FLAG_IGNORE_CASE , FLAG_IGNORE_SPACE , FLAG_LONG_LINES , FLAG_UTF8 , FLAG_LONGEST , FLAG_ROLLING_HASH , FLAG_THREADS , FLAG_CACHE , FLAG_MAX_EDITS , FLAG_STATS , FLAG_OUTPUT , FLAG_BATCH_FILES
 				   , FLAG_IGNORE_SPACE
 				   , FLAG_IGNORE_CASE
+				   , FLAG_LONG_LINES , MAX_INPUT_LEN
+				   , FLAG_UTF8
+				   , FLAG_LONGEST
+				   , FLAG_ROLLING_HASH
+				   , FLAG_THREADS , FLAG_BATCH_FILES
+				   , FLAG_CACHE
+				   , FLAG_MAX_EDITS , APPROX_MAX_EDITS
+				   , FLAG_STATS
+				   , FLAG_OUTPUT
+				   , FLAG_BATCH_FILES
 			);
 }
 
-static int parseArguments(const int argc, char** argv, bool *ignoreSpace, bool *ignoreCase) {
+static int setFlagOnce(bool *flag, const int opt, const char* const command) {
+	if( *flag == true ) {
+		( void ) fprintf( stderr , "Error: -%c was specified more than once\n" , opt );
+		printUsage( command );
+		return EXIT_FAILURE;
+	}
+
+	*flag = true;
+	return EXIT_SUCCESS;
+}
+
+static int parseArguments(const int argc, char** argv, struct options *options) {
+
 
+	static const struct option longOptions[] = {
+		{ "file-mode" , no_argument , NULL , OPTION_FILE_MODE },
+		{ NULL , 0 , NULL , 0 }
+	};
 
 	/* parse the actual option arguments */
 	int opt = END_OF_OPTS;
-	while( (opt=getopt(argc,argv,"si")) != END_OF_OPTS ) {
+	while( (opt=getopt_long(argc,argv,OPTSTRING,longOptions,NULL)) != END_OF_OPTS ) {
 		switch( opt ) {
-			case FLAG_IGNORE_CASE:
-				if( *ignoreCase == true ) {
-					( void ) fprintf( stderr , "Error: -%c was specified more than once\n" , FLAG_IGNORE_CASE );
+			case OPTION_FILE_MODE:
+				if( options->wholeFiles ) {
+					( void ) fprintf( stderr , "Error: --file-mode was specified more than once\n" );
 					printUsage( argv[0] );
-					return  EXIT_FAILURE;
+					return EXIT_FAILURE;
 				}
+				options->wholeFiles = true;
+				break;
 
-				*ignoreCase = true;
+			case FLAG_IGNORE_CASE:
+				if( setFlagOnce( &options->ignoreCase , opt , argv[0] ) == EXIT_FAILURE ) {
+					return EXIT_FAILURE;
+				}
 				break;
 			
 			case FLAG_IGNORE_SPACE:
-			        if( *ignoreSpace == true ) {
-				        ( void ) fprintf( stderr , "Error: -%c was specified more than once\n" , FLAG_IGNORE_SPACE );
-				        printUsage( argv[0] );
-				        return  EXIT_FAILURE;
-			        }
-
-			        *ignoreSpace = true;
-		         	break;
+				if( setFlagOnce( &options->ignoreSpace , opt , argv[0] ) == EXIT_FAILURE ) {
+					return EXIT_FAILURE;
+				}
+				break;
+
+			case FLAG_LONG_LINES:
+				if( setFlagOnce( &options->longLines , opt , argv[0] ) == EXIT_FAILURE ) {
+					return EXIT_FAILURE;
+				}
+				break;
+
+			case FLAG_UTF8:
+				if( setFlagOnce( &options->utf8 , opt , argv[0] ) == EXIT_FAILURE ) {
+					return EXIT_FAILURE;
+				}
+				break;
+
+			case FLAG_LONGEST:
+				if( setFlagOnce( &options->longest , opt , argv[0] ) == EXIT_FAILURE ) {
+					return EXIT_FAILURE;
+				}
+				break;
+
+			case FLAG_ROLLING_HASH:
+				if( setFlagOnce( &options->rollingHash , opt , argv[0] ) == EXIT_FAILURE ) {
+					return EXIT_FAILURE;
+				}
+				break;
+
+			case FLAG_BATCH_FILES:
+				if( setFlagOnce( &options->batchFiles , opt , argv[0] ) == EXIT_FAILURE ) {
+					return EXIT_FAILURE;
+				}
+				break;
+
+			case FLAG_THREADS:
+				if( options->threads != 0 ) {
+					( void ) fprintf( stderr , "Error: -%c was specified more than once\n" , FLAG_THREADS );
+					printUsage( argv[0] );
+					return EXIT_FAILURE;
+				}
+
+				if( !parseNumber( optarg , 1 , INT_MAX , &options->threads ) ) {
+					( void ) fprintf( stderr , "Error: Invalid number of threads: %s\n" , optarg );
+					printUsage( argv[0] );
+					return EXIT_FAILURE;
+				}
+				break;
 			
+			case FLAG_CACHE:
+				if( options->cacheEntries != 0 ) {
+					( void ) fprintf( stderr , "Error: -%c was specified more than once\n" , FLAG_CACHE );
+					printUsage( argv[0] );
+					return EXIT_FAILURE;
+				}
+
+				if( !parseNumber( optarg , 1 , MAX_CACHE_ENTRIES , &options->cacheEntries ) ) {
+					( void ) fprintf( stderr , "Error: Invalid number of cache entries: %s\n" , optarg );
+					printUsage( argv[0] );
+					return EXIT_FAILURE;
+				}
+				break;
+
+			case FLAG_MAX_EDITS:
+				if( options->maxEdits != -1 ) {
+					( void ) fprintf( stderr , "Error: -%c was specified more than once\n" , FLAG_MAX_EDITS );
+					printUsage( argv[0] );
+					return EXIT_FAILURE;
+				}
+
+				if( !parseNumber( optarg , 0 , APPROX_MAX_EDITS , &options->maxEdits ) ) {
+					( void ) fprintf( stderr , "Error: Invalid number of edits: %s\n" , optarg );
+					printUsage( argv[0] );
+					return EXIT_FAILURE;
+				}
+				break;
+
+			case FLAG_STATS:
+				if( options->stats != STATS_NONE ) {
+					( void ) fprintf( stderr , "Error: -%c was specified more than once\n" , FLAG_STATS );
+					printUsage( argv[0] );
+					return EXIT_FAILURE;
+				}
+
+				options->stats = statsFromName( optarg );
+				if( options->stats == STATS_NONE ) {
+					( void ) fprintf( stderr , "Error: Unknown scope: %s\n" , optarg );
+					printUsage( argv[0] );
+					return EXIT_FAILURE;
+				}
+				break;
+
+			case FLAG_OUTPUT:
+				if( options->format != -1 ) {
+					( void ) fprintf( stderr , "Error: -%c was specified more than once\n" , FLAG_OUTPUT );
+					printUsage( argv[0] );
+					return EXIT_FAILURE;
+				}
+
+				options->format = outputFormatFromName( optarg );
+				if( options->format == -1 ) {
+					( void ) fprintf( stderr , "Error: Unknown format: %s\n" , optarg );
+					printUsage( argv[0] );
+					return EXIT_FAILURE;
+				}
+				break;
+
 			//case '?': /* this case does not have any use -> equals default case */ 					
 			default: /* error unknown option */
 				( void ) fprintf( stderr , "Error: Unknown argument: %s\n", argv[ optind-1 ] );
@@ -249,6 +729,68 @@ static int parseArguments(const int argc, char** argv, bool *ignoreSpace, bool *
 		}
 	}
 
+	/* the hashes are built from the bytes of stdin */
+	if( options->rollingHash && (options->batchFiles || options->utf8) ) {
+		( void ) fprintf( stderr , "Error: -%c can not be combined with -%c or -%c\n" , FLAG_ROLLING_HASH , FLAG_BATCH_FILES , FLAG_UTF8 );
+		printUsage( argv[0] );
+		return EXIT_FAILURE;
+	}
+
+	/* the search reports positions, so there is nothing to put into a bitmap */
+	if( options->longest && (options->batchFiles || options->utf8 || options->rollingHash || options->format == OUTPUT_BITMAP) ) {
+		( void ) fprintf( stderr , "Error: -%c can not be combined with -%c, -%c, -%c or the bitmap format\n" ,
+		                  FLAG_LONGEST , FLAG_BATCH_FILES , FLAG_UTF8 , FLAG_ROLLING_HASH );
+		printUsage( argv[0] );
+		return EXIT_FAILURE;
+	}
+
+	/* the statistics are built from the bytes of the lines of stdin and do not fit into a bitmap */
+	if( options->stats != STATS_NONE && (options->batchFiles || options->utf8 || options->rollingHash || options->longest ||
+	                                     options->maxEdits >= 0 || options->cacheEntries > 0 || options->wholeFiles ||
+	                                     options->format == OUTPUT_BITMAP) ) {
+		( void ) fprintf( stderr , "Error: -%c can not be combined with -%c, -%c, -%c, -%c, -%c, -%c, --file-mode or the bitmap format\n" ,
+		                  FLAG_STATS , FLAG_BATCH_FILES , FLAG_UTF8 , FLAG_ROLLING_HASH , FLAG_LONGEST , FLAG_MAX_EDITS , FLAG_CACHE );
+		printUsage( argv[0] );
+		return EXIT_FAILURE;
+	}
+
+	/* the approximate check compares bytes of stored lines */
+	if( options->maxEdits >= 0 && (options->utf8 || options->rollingHash || options->longest || options->wholeFiles) ) {
+		( void ) fprintf( stderr , "Error: -%c can not be combined with -%c, -%c, -%c or --file-mode\n" ,
+		                  FLAG_MAX_EDITS , FLAG_UTF8 , FLAG_ROLLING_HASH , FLAG_LONGEST );
+		printUsage( argv[0] );
+		return EXIT_FAILURE;
+	}
+
+	/* the other modes do not have a yes/no answer per stored line */
+	if( options->cacheEntries > 0 && (options->rollingHash || options->longest || options->wholeFiles) ) {
+		( void ) fprintf( stderr , "Error: -%c can not be combined with -%c, -%c or --file-mode\n" ,
+		                  FLAG_CACHE , FLAG_ROLLING_HASH , FLAG_LONGEST );
+		printUsage( argv[0] );
+		return EXIT_FAILURE;
+	}
+
+	/* the whole file is a single string, so there are no lines */
+	if( options->wholeFiles && (options->batchFiles || options->utf8 || options->rollingHash || options->longest) ) {
+		( void ) fprintf( stderr , "Error: --file-mode can not be combined with -%c, -%c, -%c or -%c\n" ,
+		                  FLAG_BATCH_FILES , FLAG_UTF8 , FLAG_ROLLING_HASH , FLAG_LONGEST );
+		printUsage( argv[0] );
+		return EXIT_FAILURE;
+	}
+
+	/* the files of the batch mode and the file mode are the non option arguments */
+	if( options->batchFiles || options->wholeFiles ) {
+		if( argc <= optind ) {
+			( void ) fprintf( stderr , "Error: %s requires at least one file!\n" , options->batchFiles ? "-f" : "--file-mode" );
+			printUsage( argv[0] );
+			return EXIT_FAILURE;
+		}
+
+		options->files     = &argv[ optind ];
+		options->fileCount = argc - optind;
+		return EXIT_SUCCESS;
+	}
+
 	/* check for non option arguments */
 	if( argc > optind ) {
 		( void ) fprintf( stderr , "Error: there are more arguments than expected!" );
@@ -259,6 +801,35 @@ static int parseArguments(const int argc, char** argv, bool *ignoreSpace, bool *
 	return EXIT_SUCCESS;
 }
 
+static int statsFromName(const char *name) {
+
+	if( strcmp( name , "line" ) == 0 ) {
+		return STATS_LINE;
+	}
+	if( strcmp( name , "stream" ) == 0 ) {
+		return STATS_STREAM;
+	}
+
+	return STATS_NONE;
+}
+
+static bool parseNumber(const char *text, const long min, const long max, long *number) {
+	char *endptr;
+	errno = 0;
+	*number = strtol( text , &endptr , 10 );
+	return errno == 0 && endptr != text && *endptr == '\0' && *number >= min && *number <= max;
+}
+
+static size_t maxLineLength(const struct options *options) {
+	/* the approximate mode is meant for long lines, so it does not have the limit either */
+	return options->longLines || options->maxEdits >= 0 ? 0 : MAX_INPUT_LEN;
+}
+
+static bool isPipe(const int fd) {
+	struct stat info;
+	return fstat( fd , &info ) == 0 && S_ISFIFO( info.st_mode );
+}
+
 static void signalHandler(int signal) {
 	/* no extra signal handling required, will just exit input loop */
 	readFromInput = false;
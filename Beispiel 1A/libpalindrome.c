@@ -0,0 +1,52 @@
+/*
+ * Batch interface of libpalindrome. The variant of the check is selected
+ * once for the whole batch and the results are packed into the bitmap a
+ * byte at a time, so a batch of short strings does not pay for the dispatch
+ * of every single string.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#include <pthread.h>
+
+#include "libpalindrome.h"
+#include "palindrom.h"
+#include "utf8.h"
+
+/* === Global Variables === */
+
+/*
+ * @brief makes sure that the tables of palindromInit are built exactly once
+ */
+static pthread_once_t initialized = PTHREAD_ONCE_INIT;
+
+/* === Implementations === */
+
+bool palindromCheckSpans(const struct palindromSpan *spans, const size_t count, const unsigned int flags,
+                         unsigned char *bitmap) {
+
+	if( (flags & ~PALINDROM_ALL_FLAGS) != 0 ) {
+		return false;
+	}
+
+	( void ) pthread_once( &initialized , palindromInit );
+
+	const bool ignoreSpace = (flags & PALINDROM_IGNORE_SPACE) != 0;
+	const bool ignoreCase  = (flags & PALINDROM_IGNORE_CASE) != 0;
+
+	const palindromVariant check = (flags & PALINDROM_UTF8) ? utf8Select( ignoreSpace , ignoreCase )
+	                                                        : palindromSelect( ignoreSpace , ignoreCase );
+
+	for( size_t first = 0; first < count; first += 8 ) {
+		const size_t end = count - first < 8 ? count : first + 8;
+
+		unsigned char byte = 0;
+		for( size_t i = first; i < end; i++ ) {
+			byte |= (unsigned char)( check( spans[i].data , spans[i].length ) ? 1 : 0 ) << (i - first);
+		}
+
+		bitmap[ first / 8 ] = byte;
+	}
+
+	return true;
+}
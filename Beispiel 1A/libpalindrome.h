@@ -0,0 +1,63 @@
+/*
+ * This header file is the public interface of libpalindrome, the palindrom
+ * check of ispalindrom as a library. Many strings are checked with a single
+ * call, the variant for the flags is selected once per call and the results
+ * are returned as a bitmap. The strings are given as spans, so they do not
+ * have to be null terminated.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#ifndef LIBPALINDROME_H
+#define LIBPALINDROME_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* === Constants === */
+
+/* flags of palindromCheckSpans, they can be combined with | */
+#define PALINDROM_IGNORE_SPACE (1U << 0)
+#define PALINDROM_IGNORE_CASE  (1U << 1)
+/* compares UTF-8 code points instead of bytes, all white space is ignored with PALINDROM_IGNORE_SPACE */
+#define PALINDROM_UTF8         (1U << 2)
+
+#define PALINDROM_ALL_FLAGS (PALINDROM_IGNORE_SPACE | PALINDROM_IGNORE_CASE | PALINDROM_UTF8)
+
+/* === Macros === */
+
+/* the library is built with -fvisibility=hidden, only the functions marked with it are exported */
+#define PALINDROM_API __attribute__((visibility("default")))
+
+/* === Type Definitions === */
+
+/*
+ * @brief A string which is checked, it may contain null chars
+ */
+struct palindromSpan {
+	const char *data;
+	size_t length;
+};
+
+/* === Prototypes === */
+
+/*
+ * @brief
+ *	checks if the strings of the spans are palindroms. The library is
+ *	initialized by the first call, it may be called by several threads at
+ *	the same time.
+ *
+ * @param spans the strings which should be checked
+ * @param count the number of spans
+ * @param flags a combination of the PALINDROM_* flags
+ * @param bitmap
+ *	output parameter for the results, it must have (count + 7) / 8 bytes.
+ *	The result of the first span is the lowest bit of the first byte, the
+ *	bits behind the last span are cleared.
+ *
+ * @return false if the flags are unknown otherwise true
+ */
+extern PALINDROM_API bool palindromCheckSpans(const struct palindromSpan *spans, const size_t count, const unsigned int flags,
+                                              unsigned char *bitmap);
+
+#endif
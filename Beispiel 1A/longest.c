@@ -0,0 +1,190 @@
+/*
+ * Search for the longest palindrom in a line with Manacher's algorithm. The
+ * radius of the palindrom around every center is initialized with the radius
+ * around the mirrored center inside the rightmost palindrom found so far, so
+ * every char is compared only a constant number of times on average.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "longest.h"
+#include "palindrom.h"
+
+/* === Prototypes === */
+
+/*
+ * @brief makes sure that the buffers can hold length entries
+ * @return false if out of memory otherwise true
+ */
+static bool reserveBuffers(struct longestBuffers *buffers, const size_t length);
+
+/*
+ * @brief
+ *	runs Manacher's algorithm on the chars and returns the start and length
+ *	of the first longest palindrom in the normalized chars
+ */
+static void manacher(const char *chars, const size_t length, size_t *odd, size_t *even,
+                     size_t *start, size_t *palindromLength);
+
+static inline size_t minSize(const size_t a, const size_t b) {
+	return a < b ? a : b;
+}
+
+/* === Implementations === */
+
+void longestInit(struct longestBuffers *buffers) {
+	buffers->chars     = NULL;
+	buffers->positions = NULL;
+	buffers->odd       = NULL;
+	buffers->even      = NULL;
+	buffers->capacity  = 0;
+}
+
+void longestFree(struct longestBuffers *buffers) {
+	free( buffers->chars );
+	free( buffers->positions );
+	free( buffers->odd );
+	free( buffers->even );
+	longestInit( buffers );
+}
+
+bool longestPalindrom(struct longestBuffers *buffers, const char *line, const size_t length,
+                      const bool ignoreSpace, const bool ignoreCase, struct longestResult *result) {
+
+	if( !reserveBuffers( buffers , length ) ) {
+		return false;
+	}
+
+	/* normalize the line, the chars are only copied if they are changed */
+	const char *chars = line;
+	size_t count = length;
+
+	if( ignoreSpace || ignoreCase ) {
+		count = 0;
+		for( size_t i = 0; i < length; i++ ) {
+			const unsigned char c = (unsigned char) line[i];
+
+			if( ignoreSpace && c == SPACE ) {
+				continue;
+			}
+
+			if( ignoreSpace ) {
+				buffers->positions[ count ] = i;
+			}
+			buffers->chars[ count++ ] = (char)( ignoreCase ? palindromLowerTable[ c ] : c );
+		}
+		chars = buffers->chars;
+	}
+
+	if( count == 0 ) {
+		result->offset = 0;
+		result->length = 0;
+		return true;
+	}
+
+	size_t start, palindromLength;
+	manacher( chars , count , buffers->odd , buffers->even , &start , &palindromLength );
+
+	/* map the normalized chars back to the line, the spaces in between are part of the palindrom */
+	if( ignoreSpace ) {
+		result->offset = buffers->positions[ start ];
+		result->length = buffers->positions[ start + palindromLength - 1 ] - result->offset + 1;
+	} else {
+		result->offset = start;
+		result->length = palindromLength;
+	}
+
+	return true;
+}
+
+static void manacher(const char *chars, const size_t length, size_t *odd, size_t *even,
+                     size_t *start, size_t *palindromLength) {
+
+	*start = 0;
+	*palindromLength = 1;
+
+	/* odd[i] = k: chars[i-k+1 .. i+k-1] is a palindrom, [left, right) is the rightmost one */
+	size_t left = 0, right = 0;
+	for( size_t i = 0; i < length; i++ ) {
+		size_t k = i < right ? minSize( odd[ left + right - 1 - i ] , right - i ) : 1;
+		while( k <= i && i + k < length && chars[ i - k ] == chars[ i + k ] ) {
+			k++;
+		}
+
+		odd[i] = k;
+		if( i + k > right ) {
+			left  = i - k + 1;
+			right = i + k;
+		}
+
+		if( 2 * k - 1 > *palindromLength ) {
+			*start = i - k + 1;
+			*palindromLength = 2 * k - 1;
+		}
+	}
+
+	/* even[i] = k: chars[i-k .. i+k-1] is a palindrom */
+	left = 0;
+	right = 0;
+	for( size_t i = 0; i < length; i++ ) {
+		size_t k = i < right ? minSize( even[ left + right - i ] , right - i ) : 0;
+		while( k < i && i + k < length && chars[ i - k - 1 ] == chars[ i + k ] ) {
+			k++;
+		}
+
+		even[i] = k;
+		if( i + k > right ) {
+			left  = i - k;
+			right = i + k;
+		}
+
+		/* the lengths of odd and even palindroms differ, so the first longest one is kept */
+		if( 2 * k > *palindromLength ) {
+			*start = i - k;
+			*palindromLength = 2 * k;
+		}
+	}
+}
+
+static bool reserveBuffers(struct longestBuffers *buffers, const size_t length) {
+
+	if( length <= buffers->capacity ) {
+		return true;
+	}
+
+	/* doubling keeps the number of reallocations logarithmic */
+	size_t capacity = buffers->capacity == 0 ? 64 : buffers->capacity;
+	while( capacity < length ) {
+		if( capacity > SIZE_MAX / 2 / sizeof(size_t) ) {
+			return false;
+		}
+		capacity *= 2;
+	}
+
+	char *chars       = (char*) realloc( buffers->chars , capacity );
+	if( chars != NULL ) {
+		buffers->chars = chars;
+	}
+	size_t *positions = (size_t*) realloc( buffers->positions , capacity * sizeof(size_t) );
+	if( positions != NULL ) {
+		buffers->positions = positions;
+	}
+	size_t *odd       = (size_t*) realloc( buffers->odd , capacity * sizeof(size_t) );
+	if( odd != NULL ) {
+		buffers->odd = odd;
+	}
+	size_t *even      = (size_t*) realloc( buffers->even , capacity * sizeof(size_t) );
+	if( even != NULL ) {
+		buffers->even = even;
+	}
+
+	if( chars == NULL || positions == NULL || odd == NULL || even == NULL ) {
+		return false;
+	}
+
+	buffers->capacity = capacity;
+	return true;
+}
@@ -0,0 +1,75 @@
+/*
+ * This header file does contain the search for the longest palindrom in a
+ * line. It uses Manacher's algorithm, so it takes linear time even for very
+ * long lines.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#ifndef LONGEST_H
+#define LONGEST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* === Type Definitions === */
+
+/*
+ * @brief The buffers of the search, they are reused for all lines and grow as needed
+ */
+struct longestBuffers {
+	/* the normalized chars of the line */
+	char *chars;
+	/* index of every normalized char in the line (only used if spaces are ignored) */
+	size_t *positions;
+	/* radius of the longest palindrom with an odd length around every char */
+	size_t *odd;
+	/* radius of the longest palindrom with an even length in front of every char */
+	size_t *even;
+	/* number of entries which are allocated for each of the arrays */
+	size_t capacity;
+};
+
+/*
+ * @brief The longest palindrom of a line
+ */
+struct longestResult {
+	/* index of the first byte of the palindrom in the line */
+	size_t offset;
+	/* number of bytes of the palindrom in the line (including ignored spaces) */
+	size_t length;
+};
+
+/* === Prototypes === */
+
+/*
+ * @brief initializes the buffers, no memory is allocated until the first line is searched
+ */
+extern void longestInit(struct longestBuffers *buffers);
+
+/*
+ * @brief frees the buffers
+ */
+extern void longestFree(struct longestBuffers *buffers);
+
+/*
+ * @brief
+ *	searches the longest palindrom in the line, if there are several the first
+ *	one is returned. With ignoreSpace the spaces are removed before the search,
+ *	so the palindrom may contain spaces but it does neither start nor end with
+ *	one. palindromInit must have been called before.
+ *
+ * @param buffers the buffers which are used for the search
+ * @param line the line which is searched
+ * @param length the number of chars in line
+ * @param ignoreSpace true if spaces should be ignored
+ * @param ignoreCase true if the case should be ignored
+ * @param result output parameter for the position of the palindrom, its length
+ *               is 0 if the line does not contain anything but spaces
+ *
+ * @return false if out of memory otherwise true
+ */
+extern bool longestPalindrom(struct longestBuffers *buffers, const char *line, const size_t length,
+                             const bool ignoreSpace, const bool ignoreCase, struct longestResult *result);
+
+#endif
@@ -0,0 +1,446 @@
+/*
+ * Output stage of ispalindrom, the results are formatted into a large buffer
+ * which is written with a single write / writev call.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#include "output.h"
+
+/* === Constants === */
+
+/* size of the buffer of an output with a file descriptor */
+#define OUTPUT_BUFFER_SIZE (1024 * 1024)
+
+/* initial size of the buffer of an output which collects the results in memory */
+#define OUTPUT_MEMORY_INITIAL (4096)
+
+#define RESULT_PALINDROM    (" is a palindrom\n")
+#define RESULT_NO_PALINDROM (" isn't a palindrom\n")
+
+/* enough for the text behind a line with two 64 bit numbers */
+#define RESULT_SIZE (96)
+
+/* === Type Definitions === */
+
+/*
+ * @brief the result of reserve
+ */
+enum reserveResult {
+	/* the output could not be written or the buffer could not be grown */
+	RESERVE_FAILED = 0,
+	/* the bytes fit into the buffer */
+	RESERVE_BUFFERED,
+	/* the buffer was flushed, but the bytes are larger than it and have to be written directly */
+	RESERVE_DIRECT
+};
+
+/* === Prototypes === */
+
+/*
+ * @brief
+ *	makes sure that length bytes can be added to the buffer, the buffer is
+ *	flushed or grown if needed
+ *
+ * @return
+ *	RESERVE_BUFFERED if they fit, RESERVE_DIRECT if they are larger than the
+ *	flushed buffer and RESERVE_FAILED if the flush or the growth failed
+ */
+static enum reserveResult reserve(struct output *out, const size_t length);
+
+/*
+ * @brief adds the line followed by the result to the output
+ * @return false if the output could not be written otherwise true
+ */
+static bool addLine(struct output *out, const char *line, const size_t length,
+                    const char *result, const size_t resultLength);
+
+/*
+ * @brief adds a single bit to the bitmap
+ * @return false if the output could not be written otherwise true
+ */
+static bool addBit(struct output *out, const bool bit);
+
+/*
+ * @brief writes all the buffers to the file descriptor, partial writes are continued
+ * @param fd the file descriptor
+ * @param buffers the buffers, they are modified if a write was partial
+ * @param count number of buffers
+ * @return false if the buffers could not be written otherwise true
+ */
+static bool writeAll(const int fd, struct iovec *buffers, int count);
+
+
+/* === Implementations === */
+
+bool outputInit(struct output *out, const int fd, const int format) {
+
+	out->fd              = fd;
+	out->format          = format;
+	out->flushEachLine   = false;
+	out->length          = 0;
+	out->capacity        = fd == OUTPUT_MEMORY ? OUTPUT_MEMORY_INITIAL : OUTPUT_BUFFER_SIZE;
+	out->pendingBits     = 0;
+	out->pendingBitCount = 0;
+	out->buffer          = (char*) malloc( out->capacity );
+
+	return out->buffer != NULL;
+}
+
+bool outputResult(struct output *out, const char *line, const size_t length, const bool palindrom) {
+
+	bool success = true;
+
+	switch( out->format ) {
+		case OUTPUT_DIGITS:
+			success = outputRaw( out , palindrom ? "1\n" : "0\n" , 2 );
+			break;
+
+		case OUTPUT_BITMAP:
+			success = addBit( out , palindrom );
+			break;
+
+		default: {
+			const char *result = palindrom ? RESULT_PALINDROM : RESULT_NO_PALINDROM;
+			success = addLine( out , line , length , result , strlen( result ) );
+			break;
+		}
+	}
+
+	if( success && out->flushEachLine ) {
+		success = outputFlush( out );
+	}
+
+	return success;
+}
+
+bool outputLongest(struct output *out, const char *line, const size_t length,
+                   const size_t offset, const size_t palindromLength) {
+
+	char result[ RESULT_SIZE ];
+	bool success = true;
+
+	if( out->format == OUTPUT_DIGITS ) {
+		const int resultLength = snprintf( result , sizeof(result) , "%zu %zu\n" , offset , palindromLength );
+		success = outputRaw( out , result , (size_t) resultLength );
+	} else {
+		const int resultLength = snprintf( result , sizeof(result) , ": longest palindrom at offset %zu with length %zu\n" ,
+		                                   offset , palindromLength );
+		success = addLine( out , line , length , result , (size_t) resultLength );
+	}
+
+	if( success && out->flushEachLine ) {
+		success = outputFlush( out );
+	}
+
+	return success;
+}
+
+bool outputStats(struct output *out, const char *label, const size_t length,
+                 const struct eertree *tree, const struct eertreeStats *stats) {
+
+	char result[ RESULT_SIZE ];
+	int resultLength = 0;
+
+	if( out->format == OUTPUT_DIGITS ) {
+		resultLength = snprintf( result , sizeof(result) , "%zu" , stats->distinct );
+		bool success = outputRaw( out , result , (size_t) resultLength );
+
+		for( size_t i = 1; success && i <= stats->longest; i++ ) {
+			if( stats->histogram[i] > 0 ) {
+				resultLength = snprintf( result , sizeof(result) , " %zu:%llu" , i , (unsigned long long) stats->histogram[i] );
+				success = outputRaw( out , result , (size_t) resultLength );
+			}
+		}
+
+		success = success && outputRaw( out , "\n" , 1 );
+		if( success && out->flushEachLine ) {
+			success = outputFlush( out );
+		}
+
+		return success;
+	}
+
+	resultLength = snprintf( result , sizeof(result) , ": %zu distinct palindroms\n" , stats->distinct );
+	bool success = addLine( out , label , length , result , (size_t) resultLength );
+
+	for( size_t i = 1; success && i <= stats->longest; i++ ) {
+		if( stats->histogram[i] > 0 ) {
+			resultLength = snprintf( result , sizeof(result) , "\tlength %zu: %llu\n" , i , (unsigned long long) stats->histogram[i] );
+			success = outputRaw( out , result , (size_t) resultLength );
+		}
+	}
+
+	for( size_t i = 0; success && i < stats->topCount; i++ ) {
+		const uint32_t node = stats->top[i];
+		const size_t palindromLength = (size_t) tree->nodes[ node ].length;
+
+		/* the palindrom is unwrapped directly into the buffer if it fits */
+		success = outputRaw( out , "\t\"" , 2 );
+		const enum reserveResult reserved = success ? reserve( out , palindromLength ) : RESERVE_FAILED;
+		success = reserved != RESERVE_FAILED;
+		if( reserved == RESERVE_BUFFERED ) {
+			eertreePalindrom( tree , node , out->buffer + out->length );
+			out->length += palindromLength;
+		} else if( success ) {
+			char *palindrom = (char*) malloc( palindromLength );
+			success = palindrom != NULL;
+			if( success ) {
+				eertreePalindrom( tree , node , palindrom );
+				success = outputRaw( out , palindrom , palindromLength );
+				free( palindrom );
+			}
+		}
+
+		if( success ) {
+			resultLength = snprintf( result , sizeof(result) , "\" occurs %llu times\n" ,
+			                         (unsigned long long) tree->nodes[ node ].count );
+			success = outputRaw( out , result , (size_t) resultLength );
+		}
+	}
+
+	if( success && out->flushEachLine ) {
+		success = outputFlush( out );
+	}
+
+	return success;
+}
+
+static bool addLine(struct output *out, const char *line, const size_t length,
+                    const char *result, const size_t resultLength) {
+
+	const enum reserveResult reserved = reserve( out , length + resultLength );
+	if( reserved == RESERVE_FAILED ) {
+		return false;
+	}
+
+	if( reserved == RESERVE_BUFFERED ) {
+		memcpy( out->buffer + out->length , line , length );
+		memcpy( out->buffer + out->length + length , result , resultLength );
+		out->length += length + resultLength;
+		return true;
+	}
+
+	/* the line does not fit into the buffer at all, write it directly */
+	struct iovec buffers[2] = {
+		{ .iov_base = (void*)line   , .iov_len = length       },
+		{ .iov_base = (void*)result , .iov_len = resultLength },
+	};
+	return writeAll( out->fd , buffers , 2 );
+}
+
+bool outputSkipped(struct output *out, const char *message) {
+
+	bool success = true;
+
+	switch( out->format ) {
+		case OUTPUT_DIGITS:
+			success = outputRaw( out , OUTPUT_SKIPPED , strlen( OUTPUT_SKIPPED ) );
+			break;
+
+		case OUTPUT_BITMAP:
+			success = addBit( out , false );
+			break;
+
+		default:
+			if( message == NULL ) {
+				return true;
+			}
+			success = outputRaw( out , message , strlen( message ) );
+			break;
+	}
+
+	if( success && out->flushEachLine ) {
+		success = outputFlush( out );
+	}
+
+	return success;
+}
+
+bool outputMessage(struct output *out, const char *message) {
+
+	if( out->format != OUTPUT_TEXT ) {
+		return true;
+	}
+
+	if( !outputRaw( out , message , strlen( message ) ) ) {
+		return false;
+	}
+
+	return out->flushEachLine ? outputFlush( out ) : true;
+}
+
+bool outputRaw(struct output *out, const char *data, const size_t length) {
+
+	const enum reserveResult reserved = reserve( out , length );
+	if( reserved == RESERVE_FAILED ) {
+		return false;
+	}
+
+	/* the data does not fit into the buffer at all, write it directly */
+	if( reserved == RESERVE_DIRECT ) {
+		struct iovec buffer = { .iov_base = (void*)data , .iov_len = length };
+		return writeAll( out->fd , &buffer , 1 );
+	}
+
+	memcpy( out->buffer + out->length , data , length );
+	out->length += length;
+	return true;
+}
+
+bool outputAppend(struct output *out, const struct output *collected) {
+
+	/* the memory output has a byte per result which has to be packed */
+	if( out->format == OUTPUT_BITMAP ) {
+		for( size_t i = 0; i < collected->length; i++ ) {
+			if( !addBit( out , collected->buffer[i] != 0 ) ) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	if( out->length + collected->length <= out->capacity ) {
+		memcpy( out->buffer + out->length , collected->buffer , collected->length );
+		out->length += collected->length;
+		return true;
+	}
+
+	/* write both buffers at once instead of copying the collected results */
+	struct iovec buffers[2] = {
+		{ .iov_base = out->buffer       , .iov_len = out->length       },
+		{ .iov_base = collected->buffer , .iov_len = collected->length },
+	};
+
+	out->length = 0;
+	return writeAll( out->fd , buffers , 2 );
+}
+
+bool outputFlush(struct output *out) {
+
+	if( out->fd == OUTPUT_MEMORY || out->length == 0 ) {
+		return true;
+	}
+
+	struct iovec buffer = { .iov_base = out->buffer , .iov_len = out->length };
+
+	out->length = 0;
+	return writeAll( out->fd , &buffer , 1 );
+}
+
+bool outputClose(struct output *out) {
+
+	bool success = true;
+
+	/* the last byte of the bitmap is padded with zeros */
+	if( out->format == OUTPUT_BITMAP && out->fd != OUTPUT_MEMORY && out->pendingBitCount > 0 ) {
+		success = outputRaw( out , (const char*)&out->pendingBits , 1 );
+		out->pendingBitCount = 0;
+	}
+
+	success = outputFlush( out ) && success;
+
+	free( out->buffer );
+	out->buffer = NULL;
+
+	return success;
+}
+
+int outputFormatFromName(const char *name) {
+
+	if( strcmp( name , "text" ) == 0 ) {
+		return OUTPUT_TEXT;
+	}
+	if( strcmp( name , "digits" ) == 0 ) {
+		return OUTPUT_DIGITS;
+	}
+	if( strcmp( name , "bitmap" ) == 0 ) {
+		return OUTPUT_BITMAP;
+	}
+
+	return -1;
+}
+
+static enum reserveResult reserve(struct output *out, const size_t length) {
+
+	if( out->length + length <= out->capacity ) {
+		return RESERVE_BUFFERED;
+	}
+
+	/* an output in memory just grows */
+	if( out->fd == OUTPUT_MEMORY ) {
+		size_t capacity = out->capacity;
+		while( capacity < out->length + length ) {
+			capacity *= 2;
+		}
+
+		char *buffer = (char*) realloc( out->buffer , capacity );
+		if( buffer == NULL ) {
+			return RESERVE_FAILED;
+		}
+
+		out->buffer   = buffer;
+		out->capacity = capacity;
+		return RESERVE_BUFFERED;
+	}
+
+	/* the buffered results are gone if the flush failed, so the error must not be hidden by a later write */
+	if( !outputFlush( out ) ) {
+		return RESERVE_FAILED;
+	}
+
+	return length <= out->capacity ? RESERVE_BUFFERED : RESERVE_DIRECT;
+}
+
+static bool addBit(struct output *out, const bool bit) {
+
+	if( out->fd == OUTPUT_MEMORY ) {
+		const char byte = bit ? 1 : 0;
+		return outputRaw( out , &byte , 1 );
+	}
+
+	out->pendingBits |= (uint8_t)(bit ? 1 : 0) << out->pendingBitCount;
+	if( ++out->pendingBitCount < 8 ) {
+		return true;
+	}
+
+	const char byte = (char)out->pendingBits;
+	out->pendingBits     = 0;
+	out->pendingBitCount = 0;
+	return outputRaw( out , &byte , 1 );
+}
+
+static bool writeAll(const int fd, struct iovec *buffers, int count) {
+
+	while( count > 0 ) {
+		const ssize_t written = writev( fd , buffers , count );
+		if( written < 0 ) {
+			if( errno == EINTR ) {
+				continue;
+			}
+			return false;
+		}
+
+		/* skip the buffers which were written completely */
+		size_t remaining = (size_t)written;
+		while( count > 0 && remaining >= buffers->iov_len ) {
+			remaining -= buffers->iov_len;
+			buffers++;
+			count--;
+		}
+
+		if( count > 0 ) {
+			buffers->iov_base  = (char*)buffers->iov_base + remaining;
+			buffers->iov_len  -= remaining;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,182 @@
+/*
+ * This header file does contain the output stage of ispalindrom. The results
+ * are collected in a large buffer which is written with a single write call
+ * once it is full, instead of formatting every result on its own.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "eertree.h"
+
+/* === Constants === */
+
+/* every line is echoed with " is a palindrom" or " isn't a palindrom" */
+#define OUTPUT_TEXT (0)
+/* a single '1' or '0' and a '\n' per line */
+#define OUTPUT_DIGITS (1)
+/* a single bit per line, the first line is the lowest bit of the first byte */
+#define OUTPUT_BITMAP (2)
+
+/* the result of an empty or too long line in the OUTPUT_DIGITS format, in the bitmap such a line is a 0 bit */
+#define OUTPUT_SKIPPED ("-\n")
+
+/* file descriptor of an output which only collects the results in memory */
+#define OUTPUT_MEMORY (-1)
+
+/* === Type Definitions === */
+
+/*
+ * @brief A buffer which collects the results before they are written to a file descriptor
+ */
+struct output {
+	/* the file descriptor to which the buffer is written or OUTPUT_MEMORY */
+	int fd;
+	/* one of OUTPUT_TEXT, OUTPUT_DIGITS or OUTPUT_BITMAP */
+	int format;
+	/* write the buffer after every line (for interactive use) */
+	bool flushEachLine;
+
+	char *buffer;
+	size_t length;
+	size_t capacity;
+
+	/* bits of the bitmap which do not fill a whole byte yet */
+	uint8_t pendingBits;
+	int pendingBitCount;
+};
+
+/* === Prototypes === */
+
+/*
+ * @brief
+ *	initializes the output, an output with the fd OUTPUT_MEMORY grows instead
+ *	of being written. In memory the bitmap format uses a byte per result which
+ *	is packed once the output is appended to an output with a file descriptor.
+ *
+ * @param out the output which should be initialized
+ * @param fd the file descriptor to which the results are written or OUTPUT_MEMORY
+ * @param format one of OUTPUT_TEXT, OUTPUT_DIGITS or OUTPUT_BITMAP
+ *
+ * @return false if out of memory otherwise true
+ */
+extern bool outputInit(struct output *out, const int fd, const int format);
+
+/*
+ * @brief adds the result of a line to the output
+ * @param out the output
+ * @param line the line which was checked (only used by OUTPUT_TEXT)
+ * @param length the number of chars in line
+ * @param palindrom true if the line is a palindrom
+ * @return false if the output could not be written otherwise true
+ */
+extern bool outputResult(struct output *out, const char *line, const size_t length, const bool palindrom);
+
+/*
+ * @brief
+ *	adds the longest palindrom of a line to the output, the format must not
+ *	be OUTPUT_BITMAP. In the OUTPUT_DIGITS format only the offset and the
+ *	length are written.
+ *
+ * @param out the output
+ * @param line the line which was searched (only used by OUTPUT_TEXT)
+ * @param length the number of chars in line
+ * @param offset the index of the first char of the palindrom in line
+ * @param palindromLength the number of chars of the palindrom
+ *
+ * @return false if the output could not be written otherwise true
+ */
+extern bool outputLongest(struct output *out, const char *line, const size_t length,
+                          const size_t offset, const size_t palindromLength);
+
+/*
+ * @brief
+ *	adds the statistics of the palindroms of a line or of the whole input to
+ *	the output, the format must not be OUTPUT_BITMAP. The OUTPUT_TEXT format
+ *	has a line with the label and the number of distinct palindroms, a line per
+ *	length of the histogram and a line per most frequent palindrom. The
+ *	OUTPUT_DIGITS format has a single line with the number of distinct
+ *	palindroms followed by length:count pairs of the histogram.
+ *
+ * @param out the output
+ * @param label the line or the name of the input (only used by OUTPUT_TEXT)
+ * @param length the number of chars in label
+ * @param tree the tree of the palindroms
+ * @param stats the statistics of the tree
+ *
+ * @return false if the output could not be written otherwise true
+ */
+extern bool outputStats(struct output *out, const char *label, const size_t length,
+                        const struct eertree *tree, const struct eertreeStats *stats);
+
+/*
+ * @brief
+ *	adds the result of a line which was not checked (empty or too long), so
+ *	there is still exactly one result per line: the message in the
+ *	OUTPUT_TEXT format, OUTPUT_SKIPPED in the OUTPUT_DIGITS format and a 0
+ *	bit in the OUTPUT_BITMAP format
+ *
+ * @param out the output
+ * @param message the null terminated message or NULL if nothing is written in the OUTPUT_TEXT format
+ *
+ * @return false if the output could not be written otherwise true
+ */
+extern bool outputSkipped(struct output *out, const char *message);
+
+/*
+ * @brief adds a message to the output, it is only written in the OUTPUT_TEXT format
+ * @param out the output
+ * @param message the null terminated message
+ * @return false if the output could not be written otherwise true
+ */
+extern bool outputMessage(struct output *out, const char *message);
+
+/*
+ * @brief adds the raw bytes to the output without formatting them
+ * @param out the output
+ * @param data the bytes which should be added
+ * @param length the number of bytes in data
+ * @return false if the output could not be written otherwise true
+ */
+extern bool outputRaw(struct output *out, const char *data, const size_t length);
+
+/*
+ * @brief
+ *	adds all results which were collected in the memory output to the output,
+ *	the buffers of both are written with a single writev if possible
+ *
+ * @param out the output with a file descriptor
+ * @param collected an output with the fd OUTPUT_MEMORY and the same format
+ *
+ * @return false if the output could not be written otherwise true
+ */
+extern bool outputAppend(struct output *out, const struct output *collected);
+
+/*
+ * @brief writes the buffer of the output to the file descriptor
+ * @param out the output
+ * @return false if the output could not be written otherwise true
+ */
+extern bool outputFlush(struct output *out);
+
+/*
+ * @brief flushes the output including an incomplete byte of the bitmap and frees the buffer
+ * @param out the output
+ * @return false if the output could not be written otherwise true
+ */
+extern bool outputClose(struct output *out);
+
+/*
+ * @brief converts the name of a format to the format
+ * @param name "text", "digits" or "bitmap"
+ * @return the format or -1 if the name is unknown
+ */
+extern int outputFormatFromName(const char *name);
+
+#endif
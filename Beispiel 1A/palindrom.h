@@ -0,0 +1,120 @@
+/*
+ * This header file does contain the functions which check if a string
+ * is a palindrom. There is a scalar reference implementation and vectorized
+ * implementations, the fastest one which is supported by the cpu is picked
+ * by palindromInit.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#ifndef PALINDROM_H
+#define PALINDROM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* === Constants === */
+
+#define SPACE (' ')
+
+/* the vectorized implementations are only available on x86 */
+#if defined(__x86_64__) || defined(__i386__)
+#define PALINDROM_X86
+#endif
+
+/* === Type Definitions === */
+
+/*
+ * @brief signature of all the functions which check if a string is a palindrom
+ */
+typedef bool (*palindromCheck)(const char* input, const size_t length, const bool ignoreSpace, const bool ignoreCase);
+
+/*
+ * @brief signature of the variants which are specialized for one combination of the flags
+ */
+typedef bool (*palindromVariant)(const char* input, const size_t length);
+
+/*
+ * @brief
+ *	signature of the functions which compare a range of chars with the mirrored
+ *	range of another part of the string, front[i] must be equal to
+ *	back[length - 1 - i] for every i
+ */
+typedef bool (*palindromMirror)(const char* front, const char* back, const size_t length);
+
+/* === Global Variables === */
+
+/*
+ * @brief
+ *	maps every char to the char which is compared if the case is ignored,
+ *	it is filled by palindromInit
+ */
+extern unsigned char palindromLowerTable[256];
+
+/* === Prototypes === */
+
+/*
+ * @brief
+ *	builds the lookup tables, detects the features of the cpu and selects the
+ *	fastest implementation. Must be called before any other function is used.
+ */
+extern void palindromInit(void);
+
+/*
+ * @brief
+ *	returns the fastest variant of the check which is specialized for the
+ *	flags, so the flags do not have to be tested for every char
+ *
+ * @param ignoreSpace true if spaces should be ignored
+ * @param ignoreCase true if the case should be ignored
+ *
+ * @return the variant which checks if a string is a palindrom
+ */
+extern palindromVariant palindromSelect(const bool ignoreSpace, const bool ignoreCase);
+
+/*
+ * @brief
+ *	returns the fastest function which compares a range with a mirrored range,
+ *	it is the building block of checks which split a string into parts
+ *
+ * @param ignoreCase true if the case should be ignored
+ *
+ * @return the function which compares the ranges
+ */
+extern palindromMirror palindromMirrorSelect(const bool ignoreCase);
+
+/*
+ * @brief this function does check of the give string (input) is a palindrom or not
+ *
+ * @param input the string which should be checked if it's a palindrom
+ * @param length the number of chars in input
+ * @param ignoreSpace true if spaces should be ignored
+ * @param ignoreCase true if the case should be ignored
+ *
+ * @return true if string is palindrom otherwise not
+ */
+extern bool isStringPalindrom(const char* input, const size_t length, const bool ignoreSpace, const bool ignoreCase);
+
+/*
+ * @brief
+ *	scalar implementation of isStringPalindrom which compares one char from
+ *	each end at a time. It is used as fallback and as reference for the
+ *	vectorized implementations.
+ */
+extern bool isStringPalindromScalar(const char* input, const size_t length, const bool ignoreSpace, const bool ignoreCase);
+
+#ifdef PALINDROM_X86
+/*
+ * @brief implementation of isStringPalindrom which compares 16 byte blocks with SSE2
+ */
+extern bool isStringPalindromSSE2(const char* input, const size_t length, const bool ignoreSpace, const bool ignoreCase);
+
+/*
+ * @brief
+ *	implementation of isStringPalindrom which compares 32 byte blocks with AVX2,
+ *	spaces are removed from the blocks with a shuffle before they are compared
+ */
+extern bool isStringPalindromAVX2(const char* input, const size_t length, const bool ignoreSpace, const bool ignoreCase);
+#endif
+
+#endif
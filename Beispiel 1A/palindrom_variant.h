@@ -0,0 +1,55 @@
+/*
+ * Template for the variants of the palindrom check which are specialized for
+ * a single combination of the flags. This file is included by palindrom.c once
+ * for every combination, so it does not have an include guard. Before it is
+ * included these macros must be defined, they are undefined at the end:
+ *
+ *  - VARIANT_SUFFIX the suffix of the names of the generated functions
+ *  - VARIANT_IGNORE_SPACE true if spaces should be ignored
+ *  - VARIANT_IGNORE_CASE true if the case should be ignored
+ *
+ * The kernels are always inlined, so the compiler removes the branches on the
+ * constant flags from the inner loops. A vector variant which loses against
+ * the scalar one is not put into the tables of palindrom.c, so the variants
+ * may be unused.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#define VARIANT_CONCAT(name, suffix) name ## suffix
+#define VARIANT_NAME(name, suffix) VARIANT_CONCAT(name, suffix)
+
+/*
+ * @brief scalar variant, the chars are normalized with the lookup table
+ */
+static bool VARIANT_NAME(scalar, VARIANT_SUFFIX)(const char* input, const size_t length) {
+
+	size_t begin = 0;
+	size_t end   = length;
+
+	return compareFromBothEnds( input , &begin , &end , VARIANT_IGNORE_SPACE , VARIANT_IGNORE_CASE , SIZE_MAX );
+}
+
+#ifdef PALINDROM_X86
+/*
+ * @brief SSE2 variant
+ */
+__attribute__((unused))
+static bool VARIANT_NAME(sse2, VARIANT_SUFFIX)(const char* input, const size_t length) {
+	return kernelSSE2( input , length , VARIANT_IGNORE_SPACE , VARIANT_IGNORE_CASE );
+}
+
+/*
+ * @brief AVX2 variant
+ */
+__attribute__((target("avx2"), unused))
+static bool VARIANT_NAME(avx2, VARIANT_SUFFIX)(const char* input, const size_t length) {
+	return kernelAVX2( input , length , VARIANT_IGNORE_SPACE , VARIANT_IGNORE_CASE );
+}
+#endif
+
+#undef VARIANT_NAME
+#undef VARIANT_CONCAT
+#undef VARIANT_SUFFIX
+#undef VARIANT_IGNORE_SPACE
+#undef VARIANT_IGNORE_CASE
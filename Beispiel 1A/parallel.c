@@ -0,0 +1,334 @@
+/*
+ * Parallel palindrom check of a single long line. The i-th char from the
+ * front is compared with the i-th char from the back, so the pairs are split
+ * into one range per thread and each thread compares its range block by
+ * block with the mirrored compare of palindrom.c. If spaces are ignored the
+ * i-th char is the i-th char which is no space, so the spaces of every block
+ * are counted in parallel first. With the prefix sums of the counts each
+ * thread finds the start of its range in both halves without scanning the
+ * whole string.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#include <stdlib.h>
+#include <signal.h>
+#include <pthread.h>
+
+#include "parallel.h"
+
+/* === Constants === */
+
+/* number of pairs which are compared between two tests for a mismatch of another thread */
+#define PARALLEL_BLOCK (64 * 1024)
+
+/* number of chars without spaces which are collected on the stack before they are compared */
+#define COMPACT_CHARS (16 * 1024)
+
+/* === Type Definitions === */
+
+/*
+ * @brief The state of a check which is shared between the threads
+ */
+struct parallelCheck {
+	const char *input;
+	size_t length;
+	bool ignoreSpace;
+	palindromMirror mirror;
+	/* number of chars without spaces in front of every block, only if spaces are ignored */
+	size_t *prefix;
+	size_t blocks;
+	/* number of chars without spaces */
+	size_t normalized;
+	/* set by the first thread which finds a mismatch, the others stop after their current block */
+	int mismatch;
+};
+
+/*
+ * @brief The part of a check which is done by a single thread
+ */
+struct parallelTask {
+	struct parallelCheck *check;
+	/* the range of blocks which are counted or of pairs which are compared */
+	size_t first;
+	size_t last;
+};
+
+/* === Global Variables === */
+
+/*
+ * @brief the settings of the variant which is returned by parallelSelect
+ */
+static palindromVariant sequentialCheck = NULL;
+static bool selectedIgnoreSpace = false;
+static bool selectedIgnoreCase = false;
+static long selectedThreads = 1;
+
+/* === Prototypes === */
+
+/*
+ * @brief the variant of parallelSelect, short lines are checked by the calling thread
+ */
+static bool parallelVariant(const char* input, const size_t length);
+
+/*
+ * @brief
+ *	runs the routine for every task, the first task and the tasks of the
+ *	threads which could not be started are run by the calling thread
+ */
+static void runTasks(void *(*routine)(void*), struct parallelTask *tasks, pthread_t *threads, const long count);
+
+/*
+ * @brief splits total items into count ranges which differ by at most one item
+ */
+static void splitRanges(struct parallelTask *tasks, const long count, const size_t total);
+
+/*
+ * @brief counts the chars which are no space in the blocks of the task
+ * @param argument the parallelTask
+ * @return always NULL
+ */
+static void *countChars(void *argument);
+
+/*
+ * @brief compares the pairs of the task until a mismatch is found by any thread
+ * @param argument the parallelTask
+ * @return always NULL
+ */
+static void *compareRange(void *argument);
+
+/*
+ * @brief returns the index in the input of the char without spaces with the given index
+ */
+static size_t locate(const struct parallelCheck *check, const size_t index);
+
+/*
+ * @brief returns true if a thread has found a mismatch
+ */
+static inline bool mismatchFound(struct parallelCheck *check) {
+	return __atomic_load_n( &check->mismatch , __ATOMIC_RELAXED ) != 0;
+}
+
+static inline size_t minSize(const size_t a, const size_t b) {
+	return a < b ? a : b;
+}
+
+/* === Implementations === */
+
+palindromVariant parallelSelect(const bool ignoreSpace, const bool ignoreCase, const long threads) {
+
+	sequentialCheck     = palindromSelect( ignoreSpace , ignoreCase );
+	selectedIgnoreSpace = ignoreSpace;
+	selectedIgnoreCase  = ignoreCase;
+	selectedThreads     = threads;
+
+	return threads > 1 ? parallelVariant : sequentialCheck;
+}
+
+static bool parallelVariant(const char* input, const size_t length) {
+
+	if( length < PARALLEL_MIN_LENGTH ) {
+		return sequentialCheck( input , length );
+	}
+
+	return isPalindromParallel( input , length , selectedIgnoreSpace , selectedIgnoreCase , selectedThreads );
+}
+
+bool isPalindromParallel(const char* input, const size_t length, const bool ignoreSpace, const bool ignoreCase,
+                         const long threads) {
+
+	/* a thread should at least get a whole block */
+	long count = threads;
+	if( (size_t) count > length / 2 / PARALLEL_BLOCK ) {
+		count = (long)( length / 2 / PARALLEL_BLOCK );
+	}
+
+	if( count < 2 ) {
+		return isStringPalindrom( input , length , ignoreSpace , ignoreCase );
+	}
+
+	struct parallelCheck check;
+	check.input       = input;
+	check.length      = length;
+	check.ignoreSpace = ignoreSpace;
+	check.mirror      = palindromMirrorSelect( ignoreCase );
+	check.prefix      = NULL;
+	check.blocks      = (length + PARALLEL_BLOCK - 1) / PARALLEL_BLOCK;
+	check.normalized  = length;
+	check.mismatch    = 0;
+
+	struct parallelTask *tasks = (struct parallelTask*) calloc( count , sizeof(struct parallelTask) );
+	pthread_t *threadIds = (pthread_t*) calloc( count , sizeof(pthread_t) );
+	if( ignoreSpace ) {
+		check.prefix = (size_t*) calloc( check.blocks + 1 , sizeof(size_t) );
+	}
+
+	/* without memory the line can still be checked by this thread */
+	if( tasks == NULL || threadIds == NULL || (ignoreSpace && check.prefix == NULL) ) {
+		free( tasks );
+		free( threadIds );
+		free( check.prefix );
+		return isStringPalindrom( input , length , ignoreSpace , ignoreCase );
+	}
+
+	for( long i = 0; i < count; i++ ) {
+		tasks[i].check = &check;
+	}
+
+	if( ignoreSpace ) {
+		/* every block stores its count behind its prefix, the sums are built afterwards */
+		splitRanges( tasks , count , check.blocks );
+		runTasks( countChars , tasks , threadIds , count );
+
+		for( size_t i = 0; i < check.blocks; i++ ) {
+			check.prefix[ i + 1 ] += check.prefix[i];
+		}
+		check.normalized = check.prefix[ check.blocks ];
+	}
+
+	splitRanges( tasks , count , check.normalized / 2 );
+	runTasks( compareRange , tasks , threadIds , count );
+
+	free( tasks );
+	free( threadIds );
+	free( check.prefix );
+
+	return check.mismatch == 0;
+}
+
+static void runTasks(void *(*routine)(void*), struct parallelTask *tasks, pthread_t *threads, const long count) {
+
+	/* SIGINT should interrupt the thread which reads the input */
+	sigset_t blocked, previous;
+	( void ) sigemptyset( &blocked );
+	( void ) sigaddset( &blocked , SIGINT );
+	( void ) pthread_sigmask( SIG_BLOCK , &blocked , &previous );
+
+	long started = 1;
+	for( ; started < count; started++ ) {
+		if( pthread_create( &threads[ started ] , NULL , routine , &tasks[ started ] ) != 0 ) {
+			break;
+		}
+	}
+
+	( void ) pthread_sigmask( SIG_SETMASK , &previous , NULL );
+
+	( void ) routine( &tasks[0] );
+	for( long i = started; i < count; i++ ) {
+		( void ) routine( &tasks[i] );
+	}
+
+	for( long i = 1; i < started; i++ ) {
+		( void ) pthread_join( threads[i] , NULL );
+	}
+}
+
+static void splitRanges(struct parallelTask *tasks, const long count, const size_t total) {
+
+	const size_t share = total / (size_t) count;
+	const size_t extra = total % (size_t) count;
+
+	size_t first = 0;
+	for( long i = 0; i < count; i++ ) {
+		tasks[i].first = first;
+		first += share + ((size_t) i < extra ? 1 : 0);
+		tasks[i].last = first;
+	}
+}
+
+static void *countChars(void *argument) {
+
+	struct parallelTask *task = (struct parallelTask*) argument;
+	struct parallelCheck *check = task->check;
+
+	for( size_t block = task->first; block < task->last; block++ ) {
+		const size_t end = minSize( (block + 1) * PARALLEL_BLOCK , check->length );
+
+		size_t chars = 0;
+		for( size_t i = block * PARALLEL_BLOCK; i < end; i++ ) {
+			chars += check->input[i] != SPACE ? 1 : 0;
+		}
+
+		check->prefix[ block + 1 ] = chars;
+	}
+
+	return NULL;
+}
+
+static void *compareRange(void *argument) {
+
+	struct parallelTask *task = (struct parallelTask*) argument;
+	struct parallelCheck *check = task->check;
+	const char *input = check->input;
+
+	if( task->first >= task->last ) {
+		return NULL;
+	}
+
+	if( !check->ignoreSpace ) {
+		size_t pairs = 0;
+		for( size_t pair = task->first; pair < task->last && !mismatchFound( check ); pair += pairs ) {
+			pairs = minSize( PARALLEL_BLOCK , task->last - pair );
+
+			if( !check->mirror( input + pair , input + check->length - pair - pairs , pairs ) ) {
+				__atomic_store_n( &check->mismatch , 1 , __ATOMIC_RELAXED );
+			}
+		}
+		return NULL;
+	}
+
+	/* the chars without spaces of both ends are collected, the back is filled from its end */
+	char front[ COMPACT_CHARS ];
+	char back[ COMPACT_CHARS ];
+
+	size_t frontIndex = locate( check , task->first );
+	size_t backIndex  = locate( check , check->normalized - 1 - task->first ) + 1;
+
+	size_t pairs = 0;
+	for( size_t pair = task->first; pair < task->last && !mismatchFound( check ); pair += pairs ) {
+		pairs = minSize( COMPACT_CHARS , task->last - pair );
+
+		for( size_t filled = 0; filled < pairs; ) {
+			const char c = input[ frontIndex++ ];
+			front[ filled ] = c;
+			filled += c != SPACE ? 1 : 0;
+		}
+
+		for( size_t filled = pairs; filled > 0; ) {
+			const char c = input[ --backIndex ];
+			back[ filled - 1 ] = c;
+			filled -= c != SPACE ? 1 : 0;
+		}
+
+		if( !check->mirror( front , back , pairs ) ) {
+			__atomic_store_n( &check->mismatch , 1 , __ATOMIC_RELAXED );
+		}
+	}
+
+	return NULL;
+}
+
+static size_t locate(const struct parallelCheck *check, const size_t index) {
+
+	/* the last block which starts in front of the char */
+	size_t low  = 0;
+	size_t high = check->blocks;
+	while( high - low > 1 ) {
+		const size_t middle = low + (high - low) / 2;
+		if( check->prefix[ middle ] <= index ) {
+			low = middle;
+		} else {
+			high = middle;
+		}
+	}
+
+	size_t seen = check->prefix[ low ];
+	for( size_t i = low * PARALLEL_BLOCK; ; i++ ) {
+		if( check->input[i] != SPACE ) {
+			if( seen == index ) {
+				return i;
+			}
+			seen++;
+		}
+	}
+}
@@ -0,0 +1,60 @@
+/*
+ * This header file does contain the parallel palindrom check of a single
+ * long line. The pairs of chars which are compared are split into ranges
+ * which are compared by several threads, the first mismatch stops all of
+ * them.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "palindrom.h"
+
+/* === Constants === */
+
+/* lines shorter than this are checked by the calling thread alone */
+#define PARALLEL_MIN_LENGTH (4 * 1024 * 1024)
+
+/* === Prototypes === */
+
+/*
+ * @brief
+ *	returns a variant of the check which compares lines of at least
+ *	PARALLEL_MIN_LENGTH chars with several threads and shorter lines with the
+ *	variant of palindromSelect. The settings are stored globally, so all
+ *	variants which are returned use the settings of the last call. With a
+ *	single thread the variant of palindromSelect is returned directly.
+ *	palindromInit must have been called before.
+ *
+ * @param ignoreSpace true if spaces should be ignored
+ * @param ignoreCase true if the case should be ignored
+ * @param threads the number of threads which compare a long line
+ *
+ * @return the variant which checks if a string is a palindrom
+ */
+extern palindromVariant parallelSelect(const bool ignoreSpace, const bool ignoreCase, const long threads);
+
+/*
+ * @brief
+ *	checks if the string is a palindrom with the given number of threads
+ *	(including the calling one). If a thread can not be started its part is
+ *	compared by the calling thread, so the result does not depend on it.
+ *	SIGINT is blocked in the threads which are started.
+ *
+ * @param input the string which should be checked
+ * @param length the number of chars in input
+ * @param ignoreSpace true if spaces should be ignored
+ * @param ignoreCase true if the case should be ignored
+ * @param threads the number of threads which compare the string
+ *
+ * @return true if string is palindrom otherwise not
+ */
+extern bool isPalindromParallel(const char* input, const size_t length, const bool ignoreSpace, const bool ignoreCase,
+                                const long threads);
+
+#endif
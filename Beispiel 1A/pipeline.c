@@ -0,0 +1,689 @@
+/*
+ * Pipeline mode of ispalindrom. The input is read into batches which are
+ * handed to the workers round robin, every worker has a ring from the reader
+ * and a ring to the writer. The writer takes the batches from the rings in
+ * the same order, so the results stay in the order of the input. Written
+ * batches are returned to the reader through another ring, so the number
+ * of batches and therefore the memory is bounded.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+
+#include "pipeline.h"
+
+/* === Constants === */
+
+/* initial number of bytes of a batch, it only grows for lines which do not fit */
+#define BATCH_SIZE (256 * 1024)
+
+/* initial number of lines of a batch */
+#define BATCH_LINES (1024)
+
+/* number of batches per worker which may be read, checked or written at the same time */
+#define BATCHES_PER_WORKER (4)
+
+/* the indices of a ring are kept in different cache lines */
+#define CACHE_LINE (64)
+
+/* a waiting thread spins, then yields and then sleeps until the ring is ready */
+#define SPIN_LIMIT (128)
+#define YIELD_LIMIT (SPIN_LIMIT + 32)
+#define SLEEP_NANOSECONDS (50 * 1000)
+
+/* === Type Definitions === */
+
+/*
+ * @brief A line in the data of a batch
+ */
+struct span {
+	size_t offset;
+	size_t length;
+	/* true if the line was longer than maxLength, it was not stored */
+	bool tooLong;
+};
+
+/*
+ * @brief A block of the input which is passed through the pipeline
+ */
+struct batch {
+	char *data;
+	size_t length;
+	size_t capacity;
+
+	struct span *lines;
+	size_t lineCount;
+	size_t lineCapacity;
+
+	/* the results of the lines, collected in memory by the worker */
+	struct output results;
+	/* true if the worker ran out of memory */
+	bool failed;
+};
+
+/*
+ * @brief A bounded lock-free ring with a single producer and a single consumer
+ */
+struct ring {
+	struct batch **slots;
+	size_t mask;
+	char slotsPadding[ CACHE_LINE - sizeof(struct batch**) - sizeof(size_t) ];
+	/* index of the next slot which is read, only written by the consumer */
+	size_t head;
+	char headPadding[ CACHE_LINE - sizeof(size_t) ];
+	/* index of the next slot which is written, only written by the producer */
+	size_t tail;
+	char tailPadding[ CACHE_LINE - sizeof(size_t) ];
+};
+
+/*
+ * @brief The state which is shared by all stages
+ */
+struct pipeline {
+	/* toWorkers[i] and toWriter[i] belong to worker i, the last ring returns the written batches */
+	struct ring *rings;
+	struct ring *toWorkers;
+	struct ring *toWriter;
+	struct ring *freeBatches;
+	size_t ringCount;
+	long workerCount;
+
+	struct batch *batches;
+	size_t batchCount;
+
+	palindromVariant check;
+	/* settings of the result caches of the workers, NULL without caches */
+	const struct cacheConfig *cache;
+	const char *tooLongMessage;
+	struct output *out;
+
+	/* set by the writer if the results could not be written, the reader stops then */
+	int failed;
+};
+
+/*
+ * @brief The argument of a worker thread
+ */
+struct worker {
+	struct pipeline *pipeline;
+	long index;
+	pthread_t thread;
+	/* the result cache of the worker, NULL without cache */
+	struct palindromCache *cache;
+	struct palindromCache cacheMemory;
+};
+
+/* === Global Variables === */
+
+/*
+ * @brief marks the end of the input, it is passed through the rings like a batch
+ */
+static struct batch endOfInput;
+
+/* === Prototypes === */
+
+/*
+ * @brief allocates the rings and the batches, all batches are put into the free ring
+ * @return false if out of memory otherwise true
+ */
+static bool createPipeline(struct pipeline *pipeline, const long workerCount);
+
+/*
+ * @brief frees the rings and the batches
+ */
+static void destroyPipeline(struct pipeline *pipeline);
+
+/*
+ * @brief
+ *	reads the input into batches and passes them to the workers until the
+ *	end of the input, running is cleared or the writer failed
+ *
+ * @return EXIT_SUCCESS or EXIT_FAILURE
+ */
+static int readInput(struct pipeline *pipeline, const int fd, const size_t maxLength,
+                     volatile sig_atomic_t *running);
+
+/*
+ * @brief entry point of the worker threads, checks the batches from its ring
+ * @param argument the worker
+ * @return always NULL
+ */
+static void *worker(void *argument);
+
+/*
+ * @brief entry point of the writer thread, writes the results in the order of the batches
+ * @param argument the pipeline
+ * @return always NULL
+ */
+static void *writer(void *argument);
+
+/*
+ * @brief checks all lines of the batch and adds the results to the output of the batch
+ */
+static void checkBatch(const struct pipeline *pipeline, struct batch *batch, struct palindromCache *cache);
+
+/*
+ * @brief adds a line to the batch
+ * @return false if out of memory otherwise true
+ */
+static bool addLine(struct batch *batch, const size_t offset, const size_t length, const bool tooLong);
+
+/*
+ * @brief makes sure that the data of the batch can hold at least capacity bytes
+ * @return false if out of memory otherwise true
+ */
+static bool reserveData(struct batch *batch, const size_t capacity);
+
+/*
+ * @brief adds the batch to the ring
+ * @return false if the ring is full otherwise true
+ */
+static inline bool ringPush(struct ring *ring, struct batch *batch);
+
+/*
+ * @brief removes the oldest batch from the ring
+ * @return the batch or NULL if the ring is empty
+ */
+static inline struct batch *ringPop(struct ring *ring);
+
+/*
+ * @brief adds the batch to the ring, waits until there is space
+ */
+static void waitPush(struct ring *ring, struct batch *batch);
+
+/*
+ * @brief removes the oldest batch from the ring, waits until there is one
+ */
+static struct batch *waitPop(struct ring *ring);
+
+/*
+ * @brief waits a little bit longer with every attempt
+ */
+static void backoff(unsigned *attempt);
+
+/* === Implementations === */
+
+int checkPipeline(const int fd, const palindromVariant check, const size_t maxLength,
+                  const char *tooLongMessage, const long threads,
+                  struct output *out, volatile sig_atomic_t *running, const struct cacheConfig *cache) {
+
+	struct pipeline pipeline;
+	pipeline.check          = check;
+	pipeline.cache          = cache;
+	pipeline.tooLongMessage = tooLongMessage;
+	pipeline.out            = out;
+	pipeline.failed         = false;
+
+	if( !createPipeline( &pipeline , threads ) ) {
+		( void ) fprintf( stderr , "Error: Out of Memory!\n" );
+		return EXIT_FAILURE;
+	}
+
+	struct worker *workers = (struct worker*) calloc( (size_t)threads , sizeof(struct worker) );
+	if( workers == NULL ) {
+		( void ) fprintf( stderr , "Error: Out of Memory!\n" );
+		destroyPipeline( &pipeline );
+		return EXIT_FAILURE;
+	}
+
+	/* only the reader (this thread) should be interrupted by SIGINT */
+	sigset_t blocked, previous;
+	( void ) sigemptyset( &blocked );
+	( void ) sigaddset( &blocked , SIGINT );
+	( void ) pthread_sigmask( SIG_BLOCK , &blocked , &previous );
+
+	/* the batches are distributed to the workers which could be started */
+	long started = 0;
+	for( ; started < threads; started++ ) {
+		workers[ started ].pipeline = &pipeline;
+		workers[ started ].index    = started;
+		if( pthread_create( &workers[ started ].thread , NULL , worker , &workers[ started ] ) != 0 ) {
+			break;
+		}
+	}
+	pipeline.workerCount = started;
+
+	pthread_t writerThread;
+	const bool writerStarted = started > 0 && pthread_create( &writerThread , NULL , writer , &pipeline ) == 0;
+
+	( void ) pthread_sigmask( SIG_SETMASK , &previous , NULL );
+
+	int ret = EXIT_FAILURE;
+	if( writerStarted ) {
+		ret = readInput( &pipeline , fd , maxLength , running );
+	} else {
+		( void ) fprintf( stderr , "Error: Unable to start a worker thread!\n" );
+	}
+
+	/* every worker passes the end to the writer */
+	for( long i = 0; i < started; i++ ) {
+		waitPush( &pipeline.toWorkers[i] , &endOfInput );
+	}
+
+	for( long i = 0; i < started; i++ ) {
+		( void ) pthread_join( workers[i].thread , NULL );
+	}
+
+	if( writerStarted ) {
+		( void ) pthread_join( writerThread , NULL );
+	}
+
+	if( __atomic_load_n( &pipeline.failed , __ATOMIC_ACQUIRE ) ) {
+		ret = EXIT_FAILURE;
+	}
+
+	free( workers );
+	destroyPipeline( &pipeline );
+
+	return ret;
+}
+
+static int readInput(struct pipeline *pipeline, const int fd, const size_t maxLength,
+                     volatile sig_atomic_t *running) {
+
+	struct batch *current = waitPop( pipeline->freeBatches );
+	current->length    = 0;
+	current->lineCount = 0;
+
+	/* lineStart is the start of the incomplete line, scanned the end of the searched bytes */
+	size_t lineStart = 0;
+	size_t scanned   = 0;
+	/* true while the rest of a line which is too long is skipped */
+	bool skipping = false;
+	long next = 0;
+
+	int ret = EXIT_SUCCESS;
+	bool endOfFile = false;
+
+	while( *running && !__atomic_load_n( &pipeline->failed , __ATOMIC_ACQUIRE ) ) {
+
+		/* a single line fills the whole batch, this only happens if the length is unbounded */
+		if( current->length == current->capacity && !reserveData( current , current->capacity * 2 ) ) {
+			( void ) fprintf( stderr , "Error: Out of Memory!\n" );
+			ret = EXIT_FAILURE;
+			break;
+		}
+
+		const ssize_t count = read( fd , current->data + current->length , current->capacity - current->length );
+		if( count < 0 ) {
+			/* Ctrl-C interrupts the read, running tells if it was SIGINT */
+			if( errno == EINTR ) {
+				continue;
+			}
+
+			( void ) fprintf( stderr , "Error: Unable to read the input: %s\n" , strerror( errno ) );
+			ret = EXIT_FAILURE;
+			break;
+		}
+
+		if( count == 0 ) {
+			endOfFile = true;
+			break;
+		}
+
+		current->length += (size_t)count;
+
+		/* split the new bytes into lines */
+		const char *newline = NULL;
+		while( scanned < current->length
+		    && (newline = memchr( current->data + scanned , '\n' , current->length - scanned )) != NULL ) {
+
+			const size_t lineEnd = (size_t)(newline - current->data);
+			const size_t length  = lineEnd - lineStart;
+
+			bool added = true;
+			if( skipping ) {
+				added = addLine( current , lineStart , 0 , true );
+				skipping = false;
+			} else {
+				/* empty lines are kept, so they get a result as well */
+				added = addLine( current , lineStart , length , maxLength > 0 && length > maxLength );
+			}
+
+			if( !added ) {
+				( void ) fprintf( stderr , "Error: Out of Memory!\n" );
+				ret = EXIT_FAILURE;
+				break;
+			}
+
+			lineStart = scanned = lineEnd + 1;
+		}
+
+		if( ret == EXIT_FAILURE ) {
+			break;
+		}
+
+		/* a line which is too long is not kept */
+		if( maxLength > 0 && current->length - lineStart > maxLength ) {
+			skipping = true;
+		}
+		if( skipping ) {
+			current->length = lineStart;
+		}
+		scanned = current->length;
+
+		if( current->lineCount == 0 ) {
+			continue;
+		}
+
+		/* move the incomplete line to the next batch and pass this one to a worker */
+		struct batch *following = waitPop( pipeline->freeBatches );
+		const size_t rest = current->length - lineStart;
+
+		following->length    = 0;
+		following->lineCount = 0;
+		if( !reserveData( following , rest ) ) {
+			( void ) fprintf( stderr , "Error: Out of Memory!\n" );
+			ret = EXIT_FAILURE;
+			break;
+		}
+
+		memcpy( following->data , current->data + lineStart , rest );
+		following->length = rest;
+
+		waitPush( &pipeline->toWorkers[ next ] , current );
+		next = (next + 1) % pipeline->workerCount;
+
+		current   = following;
+		lineStart = 0;
+		scanned   = rest;
+	}
+
+	/* the last line might not be terminated by a '\n' */
+	if( endOfFile && ret == EXIT_SUCCESS ) {
+		const size_t length = current->length - lineStart;
+
+		bool added = true;
+		if( skipping ) {
+			added = addLine( current , lineStart , 0 , true );
+		} else if( length > 0 ) {
+			added = addLine( current , lineStart , length , maxLength > 0 && length > maxLength );
+		}
+
+		if( !added ) {
+			( void ) fprintf( stderr , "Error: Out of Memory!\n" );
+			ret = EXIT_FAILURE;
+		}
+	}
+
+	if( current->lineCount > 0 && ret == EXIT_SUCCESS ) {
+		waitPush( &pipeline->toWorkers[ next ] , current );
+	}
+
+	return ret;
+}
+
+static void *worker(void *argument) {
+
+	struct worker *self = (struct worker*) argument;
+	struct pipeline *pipeline = self->pipeline;
+
+	/* without memory for the cache the lines are just checked */
+	self->cache = NULL;
+	if( pipeline->cache != NULL && cacheInit( &self->cacheMemory , pipeline->cache , pipeline->check ) ) {
+		self->cache = &self->cacheMemory;
+	}
+
+	while( true ) {
+		struct batch *batch = waitPop( &pipeline->toWorkers[ self->index ] );
+
+		if( batch != &endOfInput ) {
+			checkBatch( pipeline , batch , self->cache );
+		}
+
+		waitPush( &pipeline->toWriter[ self->index ] , batch );
+
+		if( batch == &endOfInput ) {
+			break;
+		}
+	}
+
+	if( self->cache != NULL ) {
+		cacheFree( self->cache );
+	}
+
+	return NULL;
+}
+
+static void checkBatch(const struct pipeline *pipeline, struct batch *batch, struct palindromCache *cache) {
+
+	batch->results.length = 0;
+	batch->failed = false;
+
+	for( size_t i = 0; i < batch->lineCount && !batch->failed; i++ ) {
+		const struct span *line = &batch->lines[i];
+
+		if( line->tooLong || line->length == 0 ) {
+			batch->failed = !outputSkipped( &batch->results , line->tooLong ? pipeline->tooLongMessage : NULL );
+			continue;
+		}
+
+		const char *data = batch->data + line->offset;
+		const bool palindrom = cache != NULL ? cacheCheck( cache , data , line->length ) : pipeline->check( data , line->length );
+		batch->failed = !outputResult( &batch->results , data , line->length , palindrom );
+	}
+}
+
+static void *writer(void *argument) {
+
+	struct pipeline *pipeline = (struct pipeline*) argument;
+	bool failed = false;
+	long index = 0;
+
+	/* the batches are taken in the order in which they were distributed */
+	while( true ) {
+		struct batch *batch = waitPop( &pipeline->toWriter[ index ] );
+		if( batch == &endOfInput ) {
+			break;
+		}
+
+		index = (index + 1) % pipeline->workerCount;
+
+		/* after an error the batches are only returned, so no stage blocks forever */
+		if( !failed ) {
+			if( batch->failed ) {
+				( void ) fprintf( stderr , "Error: Out of Memory!\n" );
+				failed = true;
+			} else if( !outputAppend( pipeline->out , &batch->results ) ) {
+				( void ) fprintf( stderr , "Error: Unable to write the results: %s\n" , strerror( errno ) );
+				failed = true;
+			}
+
+			if( failed ) {
+				__atomic_store_n( &pipeline->failed , true , __ATOMIC_RELEASE );
+			}
+		}
+
+		waitPush( pipeline->freeBatches , batch );
+	}
+
+	return NULL;
+}
+
+static bool createPipeline(struct pipeline *pipeline, const long workerCount) {
+
+	pipeline->workerCount = workerCount;
+	pipeline->batchCount  = (size_t)workerCount * BATCHES_PER_WORKER + 2;
+
+	/* a ring can hold all batches and the end, so only the free batches limit the reader */
+	size_t capacity = 1;
+	while( capacity < pipeline->batchCount + 1 ) {
+		capacity *= 2;
+	}
+
+	pipeline->ringCount = 2 * (size_t)workerCount + 1;
+	void *memory = NULL;
+	if( posix_memalign( &memory , CACHE_LINE , pipeline->ringCount * sizeof(struct ring) ) != 0 ) {
+		return false;
+	}
+
+	pipeline->rings       = (struct ring*) memory;
+	pipeline->toWorkers   = pipeline->rings;
+	pipeline->toWriter    = pipeline->rings + workerCount;
+	pipeline->freeBatches = pipeline->rings + 2 * workerCount;
+
+	pipeline->batches = (struct batch*) calloc( pipeline->batchCount , sizeof(struct batch) );
+	if( pipeline->batches == NULL ) {
+		free( pipeline->rings );
+		return false;
+	}
+
+	bool success = true;
+	for( size_t i = 0; i < pipeline->ringCount; i++ ) {
+		pipeline->rings[i].head  = 0;
+		pipeline->rings[i].tail  = 0;
+		pipeline->rings[i].mask  = capacity - 1;
+		pipeline->rings[i].slots = (struct batch**) calloc( capacity , sizeof(struct batch*) );
+		success = success && pipeline->rings[i].slots != NULL;
+	}
+
+	for( size_t i = 0; i < pipeline->batchCount; i++ ) {
+		struct batch *batch = &pipeline->batches[i];
+
+		batch->data         = (char*) malloc( BATCH_SIZE );
+		batch->capacity     = BATCH_SIZE;
+		batch->lines        = (struct span*) malloc( BATCH_LINES * sizeof(struct span) );
+		batch->lineCapacity = BATCH_LINES;
+
+		success = success && batch->data != NULL && batch->lines != NULL
+		       && outputInit( &batch->results , OUTPUT_MEMORY , pipeline->out->format );
+
+		if( success ) {
+			( void ) ringPush( pipeline->freeBatches , batch );
+		}
+	}
+
+	if( !success ) {
+		destroyPipeline( pipeline );
+	}
+
+	return success;
+}
+
+static void destroyPipeline(struct pipeline *pipeline) {
+
+	for( size_t i = 0; i < pipeline->batchCount; i++ ) {
+		free( pipeline->batches[i].data );
+		free( pipeline->batches[i].lines );
+		if( pipeline->batches[i].results.buffer != NULL ) {
+			( void ) outputClose( &pipeline->batches[i].results );
+		}
+	}
+
+	for( size_t i = 0; i < pipeline->ringCount; i++ ) {
+		free( pipeline->rings[i].slots );
+	}
+
+	free( pipeline->batches );
+	free( pipeline->rings );
+}
+
+static bool addLine(struct batch *batch, const size_t offset, const size_t length, const bool tooLong) {
+
+	if( batch->lineCount == batch->lineCapacity ) {
+		struct span *lines = (struct span*) realloc( batch->lines , 2 * batch->lineCapacity * sizeof(struct span) );
+		if( lines == NULL ) {
+			return false;
+		}
+
+		batch->lines = lines;
+		batch->lineCapacity *= 2;
+	}
+
+	batch->lines[ batch->lineCount ].offset  = offset;
+	batch->lines[ batch->lineCount ].length  = length;
+	batch->lines[ batch->lineCount ].tooLong = tooLong;
+	batch->lineCount++;
+
+	return true;
+}
+
+static bool reserveData(struct batch *batch, const size_t capacity) {
+
+	if( capacity <= batch->capacity ) {
+		return true;
+	}
+
+	char *data = (char*) realloc( batch->data , capacity );
+	if( data == NULL ) {
+		return false;
+	}
+
+	batch->data     = data;
+	batch->capacity = capacity;
+	return true;
+}
+
+static inline bool ringPush(struct ring *ring, struct batch *batch) {
+
+	const size_t tail = __atomic_load_n( &ring->tail , __ATOMIC_RELAXED );
+	const size_t head = __atomic_load_n( &ring->head , __ATOMIC_ACQUIRE );
+
+	if( tail - head > ring->mask ) {
+		return false;
+	}
+
+	/* the release publishes the slot together with the new tail */
+	ring->slots[ tail & ring->mask ] = batch;
+	__atomic_store_n( &ring->tail , tail + 1 , __ATOMIC_RELEASE );
+
+	return true;
+}
+
+static inline struct batch *ringPop(struct ring *ring) {
+
+	const size_t head = __atomic_load_n( &ring->head , __ATOMIC_RELAXED );
+	const size_t tail = __atomic_load_n( &ring->tail , __ATOMIC_ACQUIRE );
+
+	if( head == tail ) {
+		return NULL;
+	}
+
+	struct batch *batch = ring->slots[ head & ring->mask ];
+	__atomic_store_n( &ring->head , head + 1 , __ATOMIC_RELEASE );
+
+	return batch;
+}
+
+static void waitPush(struct ring *ring, struct batch *batch) {
+	unsigned attempt = 0;
+	while( !ringPush( ring , batch ) ) {
+		backoff( &attempt );
+	}
+}
+
+static struct batch *waitPop(struct ring *ring) {
+	unsigned attempt = 0;
+	struct batch *batch = NULL;
+	while( (batch = ringPop( ring )) == NULL ) {
+		backoff( &attempt );
+	}
+
+	return batch;
+}
+
+static void backoff(unsigned *attempt) {
+
+	if( *attempt < SPIN_LIMIT ) {
+#ifdef PALINDROM_X86
+		__builtin_ia32_pause();
+#endif
+		(*attempt)++;
+	} else if( *attempt < YIELD_LIMIT ) {
+		( void ) sched_yield();
+		(*attempt)++;
+	} else {
+		/* the input is idle, do not burn the cpu */
+		const struct timespec pause = { 0 , SLEEP_NANOSECONDS };
+		( void ) nanosleep( &pause , NULL );
+	}
+}
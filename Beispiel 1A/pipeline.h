@@ -0,0 +1,46 @@
+/*
+ * This header file does contain the pipeline mode of ispalindrom for input
+ * from a pipe. The calling thread reads the input in large blocks and splits
+ * it into lines, worker threads check the lines and a writer thread writes
+ * the results. The stages are connected by lock-free single producer single
+ * consumer rings.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <signal.h>
+
+#include "palindrom.h"
+#include "output.h"
+#include "cache.h"
+
+/* === Prototypes === */
+
+/*
+ * @brief
+ *	checks every line which is read from the file descriptor and adds the
+ *	results to the output in the order of the input. The calling thread reads
+ *	the input, so a signal which clears running interrupts the read. SIGINT is
+ *	blocked in the threads which are started by this function.
+ *
+ * @param fd the file descriptor from which the lines are read
+ * @param check the variant of the palindrom check for the flags
+ * @param maxLength maximum number of chars of a line or 0 if the length is unbounded
+ * @param tooLongMessage the message which is added to the output for a line which is too long
+ * @param threads number of worker threads which check the lines
+ * @param out the output to which the results are added
+ * @param running the input is only read as long as this flag is true
+ * @param cache the settings of the result caches of the workers or NULL if the results are not cached
+ *
+ * @return EXIT_SUCCESS or EXIT_FAILURE
+ */
+extern int checkPipeline(const int fd, const palindromVariant check, const size_t maxLength,
+                         const char *tooLongMessage, const long threads,
+                         struct output *out, volatile sig_atomic_t *running, const struct cacheConfig *cache);
+
+#endif
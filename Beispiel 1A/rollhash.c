@@ -0,0 +1,212 @@
+/*
+ * Streaming mode of the palindrom check. For the normalized chars c[0..n-1]
+ * of a line the forward hash is sum c[i] * B^i and the reverse hash is
+ * sum c[i] * B^(n-1-i), they are equal for every base B if the line is a
+ * palindrom. Both are updated with every char, so the line is never stored.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+
+#include "rollhash.h"
+#include "palindrom.h"
+
+/* === Constants === */
+
+/* the hashes are computed modulo the mersenne prime 2^61 - 1 */
+#define HASH_MODULUS ((UINT64_C(1) << 61) - 1)
+#define HASH_COUNT (2)
+
+/* number of bytes which are read at once */
+#define STREAM_BUFFER_SIZE (64 * 1024)
+
+/* the longest label is "line " and a 64 bit number */
+#define LABEL_SIZE (32)
+
+/* === Type Definitions === */
+
+__extension__ typedef unsigned __int128 uint128;
+
+/*
+ * @brief The state of the hashes of the current line
+ */
+struct lineHash {
+	/* sum c[i] * B^i */
+	uint64_t forward[ HASH_COUNT ];
+	/* sum c[i] * B^(n-1-i) */
+	uint64_t reverse[ HASH_COUNT ];
+	/* B^n */
+	uint64_t power[ HASH_COUNT ];
+	/* number of chars of the line (including ignored chars) */
+	uint64_t length;
+};
+
+/* === Prototypes === */
+
+/*
+ * @brief returns a * b modulo HASH_MODULUS, both must be smaller than HASH_MODULUS
+ */
+static inline uint64_t multiplyMod(const uint64_t a, const uint64_t b);
+
+/*
+ * @brief returns a + b modulo HASH_MODULUS, both must be smaller than HASH_MODULUS
+ */
+static inline uint64_t addMod(const uint64_t a, const uint64_t b);
+
+/*
+ * @brief picks random bases in [256, HASH_MODULUS - 1], so no input can be built which collides
+ */
+static void randomBases(uint64_t bases[ HASH_COUNT ]);
+
+/*
+ * @brief resets the hashes to the empty line
+ */
+static void resetLine(struct lineHash *line);
+
+/*
+ * @brief adds the result of the line to the output
+ * @return false if the output could not be written otherwise true
+ */
+static bool finishLine(const struct lineHash *line, const uint64_t number, struct output *out);
+
+/* === Implementations === */
+
+int checkStream(const int fd, const bool ignoreSpace, const bool ignoreCase,
+                struct output *out, volatile sig_atomic_t *running) {
+
+	uint64_t bases[ HASH_COUNT ];
+	randomBases( bases );
+
+	static char buffer[ STREAM_BUFFER_SIZE ];
+
+	struct lineHash line;
+	resetLine( &line );
+	uint64_t number = 1;
+
+	while( *running ) {
+
+		const ssize_t count = read( fd , buffer , sizeof(buffer) );
+		if( count == 0 ) {
+			break;
+		}
+
+		if( count < 0 ) {
+			/* Ctrl-C interrupts the read, running tells if it was SIGINT */
+			if( errno == EINTR ) {
+				continue;
+			}
+
+			( void ) fprintf( stderr , "Error: Unable to read the input!\n" );
+			return EXIT_FAILURE;
+		}
+
+		for( ssize_t i = 0; i < count; i++ ) {
+			unsigned char c = (unsigned char) buffer[i];
+
+			if( c == '\n' ) {
+				/* an empty line still gets a result, an empty rest behind the last '\n' is no line */
+				const bool written = line.length == 0 ? outputSkipped( out , NULL ) : finishLine( &line , number , out );
+				if( !written ) {
+					return EXIT_FAILURE;
+				}
+
+				resetLine( &line );
+				number++;
+				continue;
+			}
+
+			line.length++;
+
+			if( ignoreSpace && c == SPACE ) {
+				continue;
+			}
+
+			if( ignoreCase ) {
+				c = palindromLowerTable[ c ];
+			}
+
+			/* 0 is a valid coefficient, the lengths of both hashes are always the same */
+			for( int h = 0; h < HASH_COUNT; h++ ) {
+				line.forward[h] = addMod( line.forward[h] , multiplyMod( c , line.power[h] ) );
+				line.reverse[h] = addMod( multiplyMod( line.reverse[h] , bases[h] ) , c );
+				line.power[h]   = multiplyMod( line.power[h] , bases[h] );
+			}
+		}
+	}
+
+	/* the last line might not be terminated by a '\n' */
+	if( *running && !finishLine( &line , number , out ) ) {
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+static bool finishLine(const struct lineHash *line, const uint64_t number, struct output *out) {
+
+	/* the end of the input behind the last '\n' */
+	if( line->length == 0 ) {
+		return true;
+	}
+
+	bool palindrom = true;
+	for( int h = 0; h < HASH_COUNT; h++ ) {
+		palindrom = palindrom && line->forward[h] == line->reverse[h];
+	}
+
+	char label[ LABEL_SIZE ];
+	const int labelLength = snprintf( label , sizeof(label) , "line %llu" , (unsigned long long) number );
+
+	return outputResult( out , label , (size_t) labelLength , palindrom );
+}
+
+static void resetLine(struct lineHash *line) {
+	for( int h = 0; h < HASH_COUNT; h++ ) {
+		line->forward[h] = 0;
+		line->reverse[h] = 0;
+		line->power[h]   = 1;
+	}
+
+	line->length = 0;
+}
+
+static void randomBases(uint64_t bases[ HASH_COUNT ]) {
+
+	uint64_t seed[ HASH_COUNT ] = { 0 , 0 };
+
+	const int random = open( "/dev/urandom" , O_RDONLY );
+	if( random == -1 || read( random , seed , sizeof(seed) ) != (ssize_t) sizeof(seed) ) {
+		/* not as good, but still unknown in advance */
+		seed[0] = (uint64_t) time( NULL ) * UINT64_C(0x9E3779B97F4A7C15) ^ (uint64_t) getpid();
+		seed[1] = seed[0] * UINT64_C(0xBF58476D1CE4E5B9) + (uint64_t) clock();
+	}
+
+	if( random != -1 ) {
+		( void ) close( random );
+	}
+
+	for( int h = 0; h < HASH_COUNT; h++ ) {
+		bases[h] = 256 + seed[h] % (HASH_MODULUS - 256);
+	}
+}
+
+static inline uint64_t multiplyMod(const uint64_t a, const uint64_t b) {
+
+	/* 2^61 = 1 modulo 2^61 - 1, so the high bits are added to the low ones */
+	const uint128 product = (uint128) a * b;
+	const uint64_t result = ((uint64_t) product & HASH_MODULUS) + (uint64_t)(product >> 61);
+
+	return result >= HASH_MODULUS ? result - HASH_MODULUS : result;
+}
+
+static inline uint64_t addMod(const uint64_t a, const uint64_t b) {
+	const uint64_t result = a + b;
+	return result >= HASH_MODULUS ? result - HASH_MODULUS : result;
+}
@@ -0,0 +1,40 @@
+/*
+ * This header file does contain the streaming mode of ispalindrom. The lines
+ * are not stored, instead a forward and a reverse polynomial hash of every
+ * line are updated for each char. A line is a palindrom if both hashes are
+ * equal, so lines of any length are checked with constant memory.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#ifndef ROLLHASH_H
+#define ROLLHASH_H
+
+#include <stdbool.h>
+#include <signal.h>
+
+#include "output.h"
+
+/* === Prototypes === */
+
+/*
+ * @brief
+ *	reads the lines from the file descriptor until EOF or until running is
+ *	cleared and adds a result per line to the output. Since the lines are not
+ *	stored they are named by their number ("line 3") in the text format.
+ *	Two hashes modulo 2^61 - 1 with random bases are used, so the probability
+ *	that a line which is no palindrom is reported as one is about n^2 / 2^122
+ *	for a line with n chars. palindromInit must have been called before.
+ *
+ * @param fd the file descriptor from which the lines are read
+ * @param ignoreSpace true if spaces should be ignored
+ * @param ignoreCase true if the case should be ignored
+ * @param out the output to which the results are added
+ * @param running the check stops once this is set to false (by a signal handler)
+ *
+ * @return EXIT_SUCCESS or EXIT_FAILURE
+ */
+extern int checkStream(const int fd, const bool ignoreSpace, const bool ignoreCase,
+                       struct output *out, volatile sig_atomic_t *running);
+
+#endif
@@ -0,0 +1,272 @@
+/*
+ * UTF-8 mode of the palindrom check, the code points are decoded from both
+ * ends of the string and compared. The case is folded with the table which is
+ * generated by gencasefold, so there are no locale calls per char.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "utf8.h"
+#include "casefold_table.h"
+
+/* === Constants === */
+
+/* invalid bytes are mapped to the (unused) low surrogates, so they only match the same byte */
+#define INVALID_BASE (0xDC00)
+
+#define ASCII_MASK (0x8080808080808080ULL)
+
+/* === Macros === */
+
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+
+#define IS_CONTINUATION(byte) (((byte) & 0xC0) == 0x80)
+
+/* === Prototypes === */
+
+/*
+ * @brief the implementation of the check, it is inlined into the variants
+ */
+static ALWAYS_INLINE bool utf8Kernel(const char* input, const size_t length, const bool ignoreSpace, const bool ignoreCase);
+
+/*
+ * @brief checks if the string does only contain ASCII chars
+ */
+static bool isAscii(const char* input, const size_t length);
+
+/*
+ * @brief
+ *	decodes the code point which starts at begin, it does not read beyond end
+ *
+ * @param input the string
+ * @param begin the index of the first byte of the code point
+ * @param end the index behind the last byte which may be read
+ * @param length output parameter for the number of bytes of the code point
+ *
+ * @return the code point or INVALID_BASE + byte if the byte does not start a valid sequence
+ */
+static inline uint32_t decodeForward(const unsigned char* input, const size_t begin, const size_t end, size_t *length);
+
+/*
+ * @brief
+ *	decodes the code point which ends in front of end, it does not read before begin
+ *
+ * @param input the string
+ * @param begin the index of the first byte which may be read
+ * @param end the index behind the last byte of the code point
+ * @param length output parameter for the number of bytes of the code point
+ *
+ * @return the code point or INVALID_BASE + byte if the last byte does not end a valid sequence
+ */
+static inline uint32_t decodeBackward(const unsigned char* input, const size_t begin, const size_t end, size_t *length);
+
+/*
+ * @brief checks if the code point is a space separator
+ */
+static inline bool isSpaceCodePoint(const uint32_t codePoint);
+
+/*
+ * @brief returns the folded code point, all case variants of a letter have the same folded code point
+ */
+static inline uint32_t foldCodePoint(const uint32_t codePoint);
+
+/* === Variants === */
+
+static bool utf8Plain(const char* input, const size_t length) {
+	return utf8Kernel( input , length , false , false );
+}
+
+static bool utf8Space(const char* input, const size_t length) {
+	return utf8Kernel( input , length , true , false );
+}
+
+static bool utf8Case(const char* input, const size_t length) {
+	return utf8Kernel( input , length , false , true );
+}
+
+static bool utf8SpaceCase(const char* input, const size_t length) {
+	return utf8Kernel( input , length , true , true );
+}
+
+
+/* === Implementations === */
+
+palindromVariant utf8Select(const bool ignoreSpace, const bool ignoreCase) {
+
+	if( ignoreSpace ) {
+		return ignoreCase ? utf8SpaceCase : utf8Space;
+	}
+
+	return ignoreCase ? utf8Case : utf8Plain;
+}
+
+bool isUtf8Palindrom(const char* input, const size_t length, const bool ignoreSpace, const bool ignoreCase) {
+	return utf8Kernel( input , length , ignoreSpace , ignoreCase );
+}
+
+static ALWAYS_INLINE bool utf8Kernel(const char* input, const size_t length, const bool ignoreSpace, const bool ignoreCase) {
+
+	/* pure ASCII strings can use the (vectorized) byte wise check */
+	if( isAscii( input , length ) ) {
+		return isStringPalindrom( input , length , ignoreSpace , ignoreCase );
+	}
+
+	const unsigned char *bytes = (const unsigned char*) input;
+	size_t begin = 0;
+	size_t end   = length;
+
+	while( begin < end ) {
+
+		uint32_t first = bytes[ begin   ];
+		uint32_t last  = bytes[ end - 1 ];
+		size_t firstLength = 1;
+		size_t lastLength  = 1;
+
+		/* decode the code points if the bytes at both ends are not ASCII chars */
+		if( first >= 0x80 || last >= 0x80 ) {
+			first = decodeForward( bytes , begin , end , &firstLength );
+		}
+
+		/* the code point in the middle does not have to be compared */
+		if( begin + firstLength >= end ) {
+			break;
+		}
+
+		if( last >= 0x80 ) {
+			last = decodeBackward( bytes , begin + firstLength , end , &lastLength );
+		}
+
+		/* do check with spaces -> skip them */
+		if( ignoreSpace && isSpaceCodePoint( first ) ) {
+			begin += firstLength;
+			continue;
+		}
+		if( ignoreSpace && isSpaceCodePoint( last ) ) {
+			end -= lastLength;
+			continue;
+		}
+
+		if( ignoreCase ) {
+			first = foldCodePoint( first );
+			last  = foldCodePoint( last  );
+		}
+
+		if( first != last ) {
+			return false;
+		}
+
+		begin += firstLength;
+		end   -= lastLength;
+	}
+
+	return true;
+}
+
+static bool isAscii(const char* input, const size_t length) {
+
+	/* check 8 bytes at once */
+	size_t i = 0;
+	uint64_t highBits = 0;
+	for( ; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t) ) {
+		uint64_t word;
+		memcpy( &word , input + i , sizeof(word) );
+		highBits |= word;
+	}
+
+	for( ; i < length; i++ ) {
+		highBits |= (unsigned char)input[i];
+	}
+
+	return (highBits & ASCII_MASK) == 0;
+}
+
+static inline uint32_t decodeForward(const unsigned char* input, const size_t begin, const size_t end, size_t *length) {
+
+	const uint32_t lead = input[ begin ];
+	*length = 1;
+
+	if( lead < 0x80 ) {
+		return lead;
+	}
+
+	/* number of continuation bytes and the allowed range of the first one (no overlong forms or surrogates) */
+	size_t continuations;
+	uint32_t codePoint;
+	unsigned char low = 0x80, high = 0xBF;
+
+	if( lead >= 0xC2 && lead <= 0xDF ) {
+		continuations = 1;
+		codePoint = lead & 0x1F;
+	} else if( lead >= 0xE0 && lead <= 0xEF ) {
+		continuations = 2;
+		codePoint = lead & 0x0F;
+		if( lead == 0xE0 ) low  = 0xA0;
+		if( lead == 0xED ) high = 0x9F;
+	} else if( lead >= 0xF0 && lead <= 0xF4 ) {
+		continuations = 3;
+		codePoint = lead & 0x07;
+		if( lead == 0xF0 ) low  = 0x90;
+		if( lead == 0xF4 ) high = 0x8F;
+	} else {
+		return INVALID_BASE + lead;
+	}
+
+	if( end - begin <= continuations ) {
+		return INVALID_BASE + lead;
+	}
+
+	for( size_t i = 1; i <= continuations; i++ ) {
+		const unsigned char byte = input[ begin + i ];
+		if( byte < low || byte > high ) {
+			return INVALID_BASE + lead;
+		}
+
+		codePoint = (codePoint << 6) | (byte & 0x3F);
+		low  = 0x80;
+		high = 0xBF;
+	}
+
+	*length = continuations + 1;
+	return codePoint;
+}
+
+static inline uint32_t decodeBackward(const unsigned char* input, const size_t begin, const size_t end, size_t *length) {
+
+	/* search the lead byte, a sequence has at most 3 continuation bytes */
+	size_t lead = end - 1;
+	while( lead > begin && end - lead < 4 && IS_CONTINUATION( input[ lead ] ) ) {
+		lead--;
+	}
+
+	/* the sequence must be valid and end exactly at end */
+	const uint32_t codePoint = decodeForward( input , lead , end , length );
+	if( lead + *length != end ) {
+		*length = 1;
+		return INVALID_BASE + input[ end - 1 ];
+	}
+
+	return codePoint;
+}
+
+static inline bool isSpaceCodePoint(const uint32_t codePoint) {
+	return codePoint == SPACE
+	    || codePoint == 0x00A0
+	    || codePoint == 0x1680
+	    || (codePoint >= 0x2000 && codePoint <= 0x200A)
+	    || codePoint == 0x202F
+	    || codePoint == 0x205F
+	    || codePoint == 0x3000;
+}
+
+static inline uint32_t foldCodePoint(const uint32_t codePoint) {
+
+	if( codePoint >= CASEFOLD_LIMIT ) {
+		return codePoint;
+	}
+
+	const uint8_t page = caseFoldIndex[ codePoint >> CASEFOLD_SHIFT ];
+	return (uint32_t)((int32_t)codePoint + caseFoldPages[ page ][ codePoint & (CASEFOLD_PAGE_SIZE - 1) ]);
+}
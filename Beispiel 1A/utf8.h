@@ -0,0 +1,47 @@
+/*
+ * This header file does contain the UTF-8 mode of the palindrom check. The
+ * code points are compared instead of the bytes, so multi-byte chars are not
+ * torn apart when the string is reversed.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "palindrom.h"
+
+/* === Prototypes === */
+
+/*
+ * @brief
+ *	returns the variant of the UTF-8 check which is specialized for the flags,
+ *	palindromInit must have been called before
+ *
+ * @param ignoreSpace true if spaces should be ignored
+ * @param ignoreCase true if the case should be ignored
+ *
+ * @return the variant which checks if a UTF-8 string is a palindrom
+ */
+extern palindromVariant utf8Select(const bool ignoreSpace, const bool ignoreCase);
+
+/*
+ * @brief
+ *	checks if the UTF-8 string is a palindrom. With ignoreSpace all space
+ *	separators are ignored, with ignoreCase the code points are folded with
+ *	a precomputed table. Invalid bytes are compared as single chars.
+ *	Strings which only consist of ASCII chars are checked with isStringPalindrom.
+ *
+ * @param input the UTF-8 string which should be checked if it's a palindrom
+ * @param length the number of bytes in input
+ * @param ignoreSpace true if spaces should be ignored
+ * @param ignoreCase true if the case should be ignored
+ *
+ * @return true if string is palindrom otherwise not
+ */
+extern bool isUtf8Palindrom(const char* input, const size_t length, const bool ignoreSpace, const bool ignoreCase);
+
+#endif
@@ -11,6 +11,9 @@
 #include <stdarg.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <netinet/in.h>
 #include <signal.h>
 #include <errno.h>
@@ -19,16 +22,19 @@
 #include <time.h>
 #include <limits.h>
 
-/* === Constants === */
+#include "mastermind.h"
+#include "strategy.h"
+#include "tree.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CLIENT_X86
+#include <immintrin.h>
+#endif
 
-#define SLOTS (5)
-#define COLORS (8)
+/* === Constants === */
 
 #define READ_BYTES (1)
 #define WRITE_BYTES (2)
-#define SHIFT_WIDTH (3)
-#define COLOR_MASK (7)
-#define PARITY_BIT (15)
 #define PARITY_ERR_BIT (1 << 6)
 #define GAME_LOST_ERR_BIT (1 << 7)
 
@@ -36,6 +42,9 @@
 #define EXIT_GAME_LOST (3)
 #define EXIT_MULTIPLE_ERRORS (4)
 
+/* Minimum number of candidates in a word for which the whole word is checked with AVX2 */
+#define AVX2_MIN_CANDIDATES (12)
+
 /* === Macros === */
 #ifdef ENDEBUG
 #define DEBUG(...) do { fprintf(stderr,__VA_ARGS__); } while(0)
@@ -48,6 +57,10 @@
 struct opts {
 	char *portno;
 	char *server;
+	enum strategy strategy;
+	long threads;
+	/* the precomputed strategy tree or NULL */
+	char *tree;
 };
 
 enum color {
@@ -72,12 +85,21 @@ static int sockfd = -1;
 /* Is signal handling needed? */
 volatile sig_atomic_t quit = 0;
 
-/* Array which holds the population for the generic algorithm */
-static uint16_t *population    = NULL;
-static uint16_t *newpopulation = NULL;
+/* Bitset of the codes which are still possible, bit i of word w is the code 64 * w + i */
+static uint64_t population[CODE_WORDS];
 
 static int populationSize = 0;
-static int newpopulationSize = 0;
+
+#ifdef CLIENT_X86
+/* Is the AVX2 filter used for dense words? Set by main */
+static int useAVX2 = 0;
+#endif
+
+/* The mapped strategy tree of -f, its nodes are used in place */
+static void *treeMap = MAP_FAILED;
+static size_t treeMapSize = 0;
+static const struct tree_node *treeNodes = NULL;
+static uint32_t treeNodeCount = 0;
 
 /* === Prototypes === */
 
@@ -120,36 +142,58 @@ static void free_resources(void);
  */
 static void signal_handler(int sig);
 
-/**
- * @breif This function is the same as in the server, it does compute the result
- * @param req_guess current guess of colors
- * @param req_secret the current secret of colors
- * @param resp output parameter where the result is stored, same way as it would come from the server
- */
-static  uint8_t compute_answer(uint16_t req_guess, uint16_t req_secret);
-
-/**
- * @brief a pow function for ints
- * @param base base for power function
- * @param exp exp for the power function
- * @return the result of the power function
- */
-static int ipow(int base, int exp);
-
+#ifdef ENDEBUG
 /**
  * @brief this function does calculate the color character to the specific color code
  * @param color the color code
  * @return character which represents the color code
  */
 static char colorToChar(uint16_t color);
+#endif
 
 /**
- * @brief this function does create the population for guessing
+ * @brief this function does remove the codes from the population which do not fit to the response
  * @param request the request which was send before this function was called
  * @param response the response of the request from the server
  */
 static void generatePopulation(uint16_t request, uint8_t response);
 
+/**
+ * @brief returns the codes of a word of the population which fit to the response
+ * @param word the index of the word
+ * @param request the request without parity bit
+ * @param response the response without error bits
+ * @return the bitset of the codes of the word which fit, codes which are no candidates are not cleared
+ */
+static uint64_t consistentWordScalar(int word, uint16_t request, uint8_t response);
+
+#ifdef CLIENT_X86
+/**
+ * @brief the AVX2 version of consistentWordScalar, all 64 codes of the word are checked in 16 bit lanes
+ */
+__attribute__((target("avx2")))
+static uint64_t consistentWordAVX2(int word, uint16_t request, uint8_t response);
+#endif
+
+/**
+ * @brief maps the strategy tree file into memory, only its size and magic are checked
+ * @param file the name of the file which was written by gentree
+ */
+static void mapTree(const char *file);
+
+/**
+ * @brief returns the next node of the strategy tree
+ * @param node the index of the node of the last request
+ * @param response the response to the request
+ * @return the index of the node with the next request
+ */
+static uint32_t nextTreeNode(uint32_t node, uint8_t response);
+
+/**
+ * @brief this function does add all codes to the population
+ */
+static void resetPopulation(void);
+
 /**
  * @brief Main Method of the Client 
  * @param argc Number of Arguments
@@ -176,29 +220,31 @@ int main(int argc,char **argv) {
 	struct opts options;
 	parse_arguments(argc, argv, &options);
 	
+	/* start the threads which score the guesses, the random strategy and the tree do not need them */
+	if( options.tree != NULL ) {
+		mapTree(options.tree);
+	}
+	options.threads = strategy_init(options.threads);
+	DEBUG("Scoring threads: %ld\n", options.threads);
+
 	/* connect to server */
 	connect_to_server(options.server, options.portno);
 	srand( time(NULL) );
 
+#ifdef CLIENT_X86
+	__builtin_cpu_init();
+	useAVX2 = __builtin_cpu_supports( "avx2" );
+#endif
+
 	uint8_t response;
 	uint16_t request;
 
 	/* inital guess */
-	request = beige 
-		| (darkblue << (SHIFT_WIDTH * 1))
-		| (green << (SHIFT_WIDTH * 2))
-		| (orange << (SHIFT_WIDTH * 3))
-		| (red << (SHIFT_WIDTH * 4))
-		;
+	uint32_t node = 0;
+	request = treeNodes != NULL ? treeNodes[node].guess : STRATEGY_FIRST_GUESS;
 
 	/* inital seed */
-	population = (uint16_t *) malloc(((sizeof(uint16_t)) * (ipow(COLORS, SLOTS))));
-	newpopulation = (uint16_t *) malloc(((sizeof(uint16_t)) * (ipow(COLORS, SLOTS))));
-	populationSize = ipow(COLORS, SLOTS);
-	
-	for (int i = 0; i < populationSize; i++) {
-		population[i] = i;
-	}
+	resetPopulation();
 
 	/* enter guess loop */
 	int rounds = 0;
@@ -206,7 +252,7 @@ int main(int argc,char **argv) {
 	while( quit == 0 ) {
 		rounds++;
 
-		request &= 0x7FFF;
+		request &= CODE_MASK;
 		DEBUG("Send Data: 0x%4x ", request);
 
 		/* send data */
@@ -251,7 +297,6 @@ int main(int argc,char **argv) {
 		}
 
 		uint8_t red = response & COLOR_MASK;
-		uint8_t white = (response >> SHIFT_WIDTH) & COLOR_MASK;
 
 		if( red == SLOTS ) {
 			(void) fprintf( stdout , "Gewonnen!\nRunden: %d\n", rounds );
@@ -259,23 +304,26 @@ int main(int argc,char **argv) {
 			break;		
 		}
 
-		DEBUG("Got Data: 0x%2x %dw %dr\n",response, white, red);
+		DEBUG("Got Data: 0x%2x %dw %dr\n",response, (response >> SHIFT_WIDTH) & COLOR_MASK, red);
+
+		/* the tree already knows the next request */
+		if (treeNodes != NULL) {
+			node = nextTreeNode(node, response);
+			request = treeNodes[node].guess;
+			continue;
+		}
 
 		generatePopulation(request, response);
 
 		if (populationSize == 0) {
 			DEBUG("Generate new Population,ran out of choices ...\n");
 
-			populationSize = ipow(COLORS, SLOTS);
-			for (int i = 0; i < populationSize; i++) {
-				population[i] = i;
-			}
-
+			resetPopulation();
 			generatePopulation(request, response);
 		}
 
 		if (populationSize > 0) {
-			request = population[rand() % populationSize];
+			request = strategy_select(options.strategy, population, populationSize);
 		} else {
 			request = rand();
 		}
@@ -293,47 +341,164 @@ int main(int argc,char **argv) {
 
 static void generatePopulation(uint16_t request, uint8_t response) {
 	response &= 0x3F; //mask parity and error bit 
-	request &= 0x7FFF; //mask parity bit
-
-	/* delete all no possible states: */
-	memset(newpopulation, 0, (sizeof(uint16_t)) * (ipow(COLORS, SLOTS)));
-	uint8_t result;
-
-	for (int i = 0; i < populationSize; i++) {
-		result = compute_answer(population[i], request);
-
-		if (result == response) {
-			/*DEBUG("Add: %c%c%c%c%c\t",
-				  colorToChar(population[i] & COLOR_MASK),
-				  colorToChar((population[i] >> (SHIFT_WIDTH * 1)) & COLOR_MASK),
-				  colorToChar((population[i] >> (SHIFT_WIDTH * 2)) & COLOR_MASK),
-				  colorToChar((population[i] >> (SHIFT_WIDTH * 3)) & COLOR_MASK),
-				  colorToChar((population[i] >> (SHIFT_WIDTH * 4)) & COLOR_MASK)
-				  );
-
-			DEBUG("Got Data: 0x%2x %dw %dr\n", result, (result >> SHIFT_WIDTH) & COLOR_MASK, result & COLOR_MASK);
-			*/
-			newpopulation[newpopulationSize] = population[i];
-			newpopulationSize++;
-		} /* else {
-			DEBUG("NOT: %d%c%c%c%c%c\t",
-				  colorToChar(population[i] & COLOR_MASK),
-				  colorToChar((population[i] >> (SHIFT_WIDTH * 1)) & COLOR_MASK),
-				  colorToChar((population[i] >> (SHIFT_WIDTH * 2)) & COLOR_MASK),
-				  colorToChar((population[i] >> (SHIFT_WIDTH * 3)) & COLOR_MASK),
-				  colorToChar((population[i] >> (SHIFT_WIDTH * 4)) & COLOR_MASK)
-				  );
-
-			DEBUG("Got Data: 0x%2x %dw %dr\n", result, (result >> SHIFT_WIDTH) & COLOR_MASK, result & COLOR_MASK);
-		} */
+	request &= CODE_MASK; //mask parity bit
+
+	/* the codes of a word which fit to the response are collected and the others are cleared */
+	populationSize = 0;
+	for (int word = 0; word < CODE_WORDS; word++) {
+		uint64_t consistent;
+
+		if (population[word] == 0) {
+			continue;
+		}
+
+#ifdef CLIENT_X86
+		if (useAVX2 && __builtin_popcountll(population[word]) >= AVX2_MIN_CANDIDATES) {
+			consistent = consistentWordAVX2(word, request, response);
+		} else
+#endif
+		{
+			consistent = consistentWordScalar(word, request, response);
+		}
+
+		population[word] &= consistent;
+		populationSize += __builtin_popcountll(population[word]);
 	}
+}
+
+static uint64_t consistentWordScalar(int word, uint16_t request, uint8_t response) {
+	uint64_t candidates = population[word];
+	uint64_t consistent = 0;
+
+	while (candidates != 0) {
+		const int bit = __builtin_ctzll(candidates);
+		candidates &= candidates - 1;
 
-	uint16_t *t = population;
-	population = newpopulation;
-	newpopulation = t;
+		const uint16_t code = (uint16_t)(word * 64 + bit);
+		consistent |= (uint64_t)(mastermind_answer(code, request) == response) << bit;
+	}
 
-	populationSize = newpopulationSize;
-	newpopulationSize = 0;
+	return consistent;
+}
+
+#ifdef CLIENT_X86
+__attribute__((target("avx2")))
+static uint64_t consistentWordAVX2(int word, uint16_t request, uint8_t response) {
+	/* the slots of the request, the reds are the slots which are equal to them */
+	__m256i guessSlot[SLOTS];
+	for (int slot = 0; slot < SLOTS; slot++) {
+		guessSlot[slot] = _mm256_set1_epi16((short)((request >> (SHIFT_WIDTH * slot)) & COLOR_MASK));
+	}
+
+	/* only the colors of the request can match, their negated counts are the
+	   limits of the negated counts of the secret (max of negated is -min) */
+	__m256i color[SLOTS];
+	__m256i limit[SLOTS];
+	int colors = 0;
+	const uint32_t counts = mastermind_color_counts(request);
+	for (int c = 0; c < COLORS; c++) {
+		const int count = (counts >> (4 * c)) & 0xF;
+		if (count > 0) {
+			color[colors] = _mm256_set1_epi16((short)c);
+			limit[colors] = _mm256_set1_epi16((short)-count);
+			colors++;
+		}
+	}
+
+	const __m256i expected = _mm256_set1_epi16(response);
+	const __m256i colorMask = _mm256_set1_epi16(COLOR_MASK);
+	const __m256i lanes = _mm256_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+	uint64_t consistent = 0;
+	for (int half = 0; half < 2; half++) {
+		__m256i fits[2];
+
+		for (int block = 0; block < 2; block++) {
+			const int first = word * 64 + half * 32 + block * 16;
+			const __m256i code = _mm256_add_epi16(_mm256_set1_epi16((short)first), lanes);
+
+			/* reds and the negated count of every color of the request */
+			__m256i red = _mm256_setzero_si256();
+			__m256i slotColor[SLOTS];
+			for (int slot = 0; slot < SLOTS; slot++) {
+				slotColor[slot] = _mm256_and_si256(_mm256_srli_epi16(code, SHIFT_WIDTH * slot), colorMask);
+				red = _mm256_sub_epi16(red, _mm256_cmpeq_epi16(slotColor[slot], guessSlot[slot]));
+			}
+
+			__m256i matches = _mm256_setzero_si256();
+			for (int c = 0; c < colors; c++) {
+				__m256i count = _mm256_setzero_si256();
+				for (int slot = 0; slot < SLOTS; slot++) {
+					count = _mm256_add_epi16(count, _mm256_cmpeq_epi16(slotColor[slot], color[c]));
+				}
+				matches = _mm256_sub_epi16(matches, _mm256_max_epi16(count, limit[c]));
+			}
+
+			const __m256i white = _mm256_sub_epi16(matches, red);
+			const __m256i answer = _mm256_or_si256(red, _mm256_slli_epi16(white, SHIFT_WIDTH));
+			fits[block] = _mm256_cmpeq_epi16(answer, expected);
+		}
+
+		/* the pack interleaves the 128 bit halves of both blocks, the permute restores the order of the codes */
+		const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(fits[0], fits[1]), 0xD8);
+		consistent |= (uint64_t)(uint32_t)_mm256_movemask_epi8(packed) << (half * 32);
+	}
+
+	return consistent;
+}
+#endif
+
+static void mapTree(const char *file) {
+	const int fd = open(file, O_RDONLY);
+	if( fd < 0 ) {
+		bail_out(EXIT_FAILURE, "open: %s", file);
+	}
+
+	struct stat info;
+	if( fstat(fd, &info) < 0 ) {
+		(void) close(fd);
+		bail_out(EXIT_FAILURE, "fstat: %s", file);
+	}
+
+	if( (size_t) info.st_size < sizeof(struct tree_header) ) {
+		(void) close(fd);
+		errno = 0;
+		bail_out(EXIT_FAILURE, "%s is no strategy tree", file);
+	}
+
+	treeMapSize = (size_t) info.st_size;
+	treeMap = mmap(NULL, treeMapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	(void) close(fd);
+	if( treeMap == MAP_FAILED ) {
+		bail_out(EXIT_FAILURE, "mmap: %s", file);
+	}
+
+	const struct tree_header *header = (const struct tree_header*) treeMap;
+	if( memcmp(header->magic, TREE_MAGIC, sizeof(TREE_MAGIC)) != 0
+	    || header->nodes == 0
+	    || treeMapSize != sizeof(struct tree_header) + (size_t) header->nodes * sizeof(struct tree_node) ) {
+		errno = 0;
+		bail_out(EXIT_FAILURE, "%s is no strategy tree", file);
+	}
+
+	treeNodes = (const struct tree_node*)(header + 1);
+	treeNodeCount = header->nodes;
+}
+
+static uint32_t nextTreeNode(uint32_t node, uint8_t response) {
+	const uint32_t next = treeNodes[node].children[response & 0x3F];
+
+	if( next == TREE_NO_CHILD || next >= treeNodeCount ) {
+		errno = 0;
+		bail_out(EXIT_FAILURE, "The response 0x%x is not in the strategy tree", response);
+	}
+
+	return next;
+}
+
+static void resetPopulation(void) {
+	(void) memset(population, 0xFF, sizeof(population));
+	populationSize = CODES;
 }
 
 static void parse_arguments(int argc, char **argv, struct opts *options) {
@@ -342,23 +507,78 @@ static void parse_arguments(int argc, char **argv, struct opts *options) {
 		progname = argv[0];
 	}
 
-	if( argc != 3 ) {
-		bail_out(EXIT_FAILURE,"Usage: %s <server-hostname> <server-port>",progname);
+	options->strategy = STRATEGY_RANDOM;
+	options->threads  = 0;
+	options->tree     = NULL;
+
+	int opt;
+	char *endptr;
+	int strategyGiven = 0;
+	while( (opt = getopt(argc, argv, "s:j:f:")) != -1 ) {
+		switch( opt ) {
+			case 's':
+				strategyGiven = 1;
+				if( strategy_parse(optarg, &options->strategy) < 0 ) {
+					bail_out(EXIT_FAILURE,"Unknown strategy: %s", optarg);
+				}
+				break;
+
+			case 'j':
+				if( options->threads != 0 ) {
+					bail_out(EXIT_FAILURE,"-j was specified more than once");
+				}
+
+				errno = 0;
+				options->threads = strtol(optarg, &endptr, 10);
+				if( errno != 0 || endptr == optarg || *endptr != '\0'
+				    || options->threads < 1 || options->threads > STRATEGY_MAX_THREADS ) {
+					errno = 0;
+					bail_out(EXIT_FAILURE,"<threads> has to be a number between 1 and %d", STRATEGY_MAX_THREADS);
+				}
+				break;
+
+			case 'f':
+				options->tree = optarg;
+				break;
+
+			default:
+				bail_out(EXIT_FAILURE,"Usage: %s [-s random | -s minimax|entropy [-j threads] | -f tree-file] <server-hostname> <server-port>",progname);
+		}
 	}
-	
-	options->server = argv[1];
-	options->portno = argv[2];
-}
 
-static void calculate_parity(uint16_t *request) {
-	uint16_t parity = 0;
+	/* the tree already holds the guesses of its strategy */
+	if( options->tree != NULL && (strategyGiven || options->threads != 0) ) {
+		bail_out(EXIT_FAILURE,"-f can not be combined with -s or -j");
+	}
 
-	for (int j = 0; j < PARITY_BIT; j++) {
-		parity ^= ((*request) >> j) & 0x1;		
+	/* the random strategy does not score guesses, so it needs no threads */
+	if( options->strategy == STRATEGY_RANDOM ) {
+		if( options->threads != 0 ) {
+			bail_out(EXIT_FAILURE,"-j can only be used with the strategies minimax and entropy");
+		}
+		options->threads = 1;
+	}
+
+	/* one thread per cpu if the number of threads was not specified */
+	if( options->threads == 0 ) {
+		options->threads = sysconf(_SC_NPROCESSORS_ONLN);
+		if( options->threads < 1 ) {
+			options->threads = 1;
+		} else if( options->threads > STRATEGY_MAX_THREADS ) {
+			options->threads = STRATEGY_MAX_THREADS;
+		}
 	}
-	parity &= 0x1;
 
-	(*request) |= (parity << PARITY_BIT);
+	if( argc - optind != 2 ) {
+		bail_out(EXIT_FAILURE,"Usage: %s [-s random | -s minimax|entropy [-j threads] | -f tree-file] <server-hostname> <server-port>",progname);
+	}
+	
+	options->server = argv[optind];
+	options->portno = argv[optind + 1];
+}
+
+static void calculate_parity(uint16_t *request) {
+	(*request) |= (mastermind_parity(*request) << PARITY_BIT);
 }
 
 static void connect_to_server(char *serverAddr,char *portNo) {
@@ -418,12 +638,10 @@ static void free_resources(void) {
 		close(sockfd);
 	}
 
-	if (population != NULL) {
-		free(population);
-	}
+	strategy_free();
 
-	if (newpopulation != NULL) {
-		free(newpopulation);
+	if( treeMap != MAP_FAILED ) {
+		(void) munmap(treeMap, treeMapSize);
 	}
 }
 
@@ -431,62 +649,8 @@ static void signal_handler(int sig) {
 	quit = 1;
 }
 
-static uint8_t compute_answer(uint16_t req_guess, uint16_t req_secret) {
-	int colors_left[COLORS];
-	int secret[SLOTS];
-	int guess[SLOTS];
-	int j,red,white;
-	uint8_t result;
-
-	/* extract data from uint16_t */
-	for (j = 0; j < SLOTS; ++j) {
-		guess[j] = req_guess & COLOR_MASK;
-		secret[j] = req_secret & COLOR_MASK;
-
-		req_guess >>= SHIFT_WIDTH;
-		req_secret >>= SHIFT_WIDTH;
-	}
-
-	/* marking red and white */
-	(void)memset(&colors_left[0], 0, sizeof(colors_left));
-	red = white = 0;
-	for (j = 0; j < SLOTS; ++j) {
-		/* mark red */
-		if (guess[j] == secret[j]) {
-			red++;
-		} else {
-			colors_left[secret[j]]++;
-		}
-	}
-	for (j = 0; j < SLOTS; ++j) {
-		/* not marked red */
-		if (guess[j] != secret[j]) {
-			if (colors_left[guess[j]] > 0) {
-				white++;
-				colors_left[guess[j]]--;
-			}
-		}
-	}
-
-	result = red;
-	result |= (white << SHIFT_WIDTH);
-	//No parity needed for internal calculation
-
-	return ( result & 0x3F );
-}
-
-static int ipow(int base, int exp) {
-	int result = 1;
-	while (exp) {
-		if (exp & 1)
-			result *= base;
-		exp >>= 1;
-		base *= base;
-	}
-
-	return result;
-}
-
+/* the colors are only printed by the traces */
+#ifdef ENDEBUG
 static char colorToChar(uint16_t color) {
 	switch (color) {
 		case beige:     return 'b';
@@ -502,4 +666,5 @@ static char colorToChar(uint16_t color) {
 	}
 
 	return '?';
-}
\ No newline at end of file
+}
+#endif
@@ -0,0 +1,295 @@
+/*
+ * Generates the complete strategy tree of a strategy for all secrets, see
+ * tree.h. Starting with all codes and the first guess of the client, the
+ * codes are split by the answer to the guess and the strategy chooses the
+ * guess of every part, until every part is won.
+ *
+ * Usage: gentree [-s minimax|entropy] [-j threads] <tree-file>
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdarg.h>
+#include <errno.h>
+
+#include "mastermind.h"
+#include "strategy.h"
+#include "tree.h"
+
+/* === Constants === */
+
+/* number of nodes for which memory is allocated at first */
+#define INITIAL_NODES (4096)
+
+/* === Type Definitions === */
+
+struct opts {
+	char *file;
+	enum strategy strategy;
+	long threads;
+};
+
+/* === Global Variables === */
+
+/* Name of Program */
+static const char *progname = "gentree";
+
+/* the nodes of the tree, node 0 is the root */
+static struct tree_node *nodes = NULL;
+static uint32_t nodeCount = 0;
+static uint32_t nodeCapacity = 0;
+
+/* the deepest level of the tree, the worst case number of rounds */
+static int maxDepth = 0;
+
+/* === Prototypes === */
+
+/**
+ * @brief Parses the command line arguments
+ * @param argc Number of Arguments
+ * @param argv The Arguments
+ * @param options Struct which does hold the extracted options
+ */
+static void parse_arguments(int argc, char **argv, struct opts *options);
+
+/**
+ * @brief adds the node of a part of the codes and the nodes of all its children
+ * @param population the codes of the part
+ * @param populationSize the number of codes of the part
+ * @param guess the guess of the node
+ * @param strategy the strategy which chooses the guesses of the children
+ * @param depth the round in which the guess is made
+ * @return the index of the node
+ */
+static uint32_t addNode(const uint64_t population[CODE_WORDS], int populationSize, uint16_t guess,
+                        enum strategy strategy, int depth);
+
+/**
+ * @brief writes the header and the nodes to the file
+ * @param file the name of the file
+ */
+static void writeTree(const char *file);
+
+/**
+ * @brief prints an error message and quits the program with exitcode
+ * @param exitcode an exit code which is returned by the program
+ * @param fmd a format string for parameters
+ */
+static void bail_out(int exitcode, const char *fmt, ...);
+
+/**
+ * @brief frees global resources in the program
+ */
+static void free_resources(void);
+
+/**
+ * @brief Main Method of the Generator
+ * @param argc Number of Arguments
+ * @param argv The arguments
+ * @return an exit code
+ */
+int main(int argc, char **argv) {
+	struct opts options;
+	parse_arguments(argc, argv, &options);
+
+	(void) strategy_init(options.threads);
+
+	static uint64_t population[CODE_WORDS];
+	(void) memset(population, 0xFF, sizeof(population));
+
+	(void) addNode(population, CODES, STRATEGY_FIRST_GUESS, options.strategy, 1);
+	writeTree(options.file);
+
+	(void) fprintf(stdout, "Nodes: %u\nMaximum rounds: %d\n", nodeCount, maxDepth);
+
+	free_resources();
+	return EXIT_SUCCESS;
+}
+
+/* === Implementation === */
+
+static uint32_t addNode(const uint64_t population[CODE_WORDS], int populationSize, uint16_t guess,
+                        enum strategy strategy, int depth) {
+	if( nodeCount == nodeCapacity ) {
+		const uint32_t capacity = nodeCapacity == 0 ? INITIAL_NODES : nodeCapacity * 2;
+		struct tree_node *grown = realloc(nodes, capacity * sizeof(struct tree_node));
+		if( grown == NULL ) {
+			bail_out(EXIT_FAILURE, "realloc");
+		}
+
+		nodes = grown;
+		nodeCapacity = capacity;
+	}
+
+	/* nodes can move while the children are added, so the node is only used by its index */
+	const uint32_t index = nodeCount++;
+	(void) memset(&nodes[index], 0, sizeof(struct tree_node));
+	nodes[index].guess = guess;
+
+	if( depth > maxDepth ) {
+		maxDepth = depth;
+	}
+
+	/* the codes of the population and their answers, a code is in the part of its answer */
+	uint16_t *codes   = malloc(populationSize * sizeof(uint16_t));
+	uint8_t  *answers = malloc(populationSize * sizeof(uint8_t));
+	uint64_t *part    = malloc(CODE_WORDS * sizeof(uint64_t));
+	if( codes == NULL || answers == NULL || part == NULL ) {
+		free(codes);
+		free(answers);
+		free(part);
+		bail_out(EXIT_FAILURE, "malloc");
+	}
+
+	int count = 0;
+	for( int word = 0; word < CODE_WORDS; word++ ) {
+		uint64_t bits = population[word];
+
+		while( bits != 0 ) {
+			codes[count]   = (uint16_t)(word * 64 + __builtin_ctzll(bits));
+			answers[count] = mastermind_answer(guess, codes[count]);
+			bits &= bits - 1;
+			count++;
+		}
+	}
+
+	for( int answer = 0; answer < ANSWERS; answer++ ) {
+		/* the guess is the only code with all reds, it wins the game */
+		if( (answer & COLOR_MASK) == SLOTS ) {
+			continue;
+		}
+
+		int partSize = 0;
+		(void) memset(part, 0, CODE_WORDS * sizeof(uint64_t));
+		for( int i = 0; i < count; i++ ) {
+			if( answers[i] == answer ) {
+				part[codes[i] / 64] |= UINT64_C(1) << (codes[i] % 64);
+				partSize++;
+			}
+		}
+
+		if( partSize == 0 ) {
+			continue;
+		}
+
+		const uint16_t next = strategy_select(strategy, part, partSize);
+		const uint32_t child = addNode(part, partSize, next, strategy, depth + 1);
+		nodes[index].children[answer] = child;
+	}
+
+	free(codes);
+	free(answers);
+	free(part);
+	return index;
+}
+
+static void writeTree(const char *file) {
+	struct tree_header header;
+	(void) memset(&header, 0, sizeof(header));
+	(void) memcpy(header.magic, TREE_MAGIC, sizeof(TREE_MAGIC));
+	header.nodes = nodeCount;
+
+	FILE *out = fopen(file, "wb");
+	if( out == NULL ) {
+		bail_out(EXIT_FAILURE, "fopen: %s", file);
+	}
+
+	if( fwrite(&header, sizeof(header), 1, out) != 1
+	    || fwrite(nodes, sizeof(struct tree_node), nodeCount, out) != nodeCount ) {
+		(void) fclose(out);
+		bail_out(EXIT_FAILURE, "fwrite: %s", file);
+	}
+
+	if( fclose(out) != 0 ) {
+		bail_out(EXIT_FAILURE, "fclose: %s", file);
+	}
+}
+
+static void parse_arguments(int argc, char **argv, struct opts *options) {
+	/* set real progname */
+	if( argc > 0 ) {
+		progname = argv[0];
+	}
+
+	options->strategy = STRATEGY_MINIMAX;
+	options->threads  = 0;
+
+	int opt;
+	char *endptr;
+	while( (opt = getopt(argc, argv, "s:j:")) != -1 ) {
+		switch( opt ) {
+			case 's':
+				if( strategy_parse(optarg, &options->strategy) < 0 ) {
+					bail_out(EXIT_FAILURE,"Unknown strategy: %s", optarg);
+				}
+				break;
+
+			case 'j':
+				if( options->threads != 0 ) {
+					bail_out(EXIT_FAILURE,"-j was specified more than once");
+				}
+
+				errno = 0;
+				options->threads = strtol(optarg, &endptr, 10);
+				if( errno != 0 || endptr == optarg || *endptr != '\0'
+				    || options->threads < 1 || options->threads > STRATEGY_MAX_THREADS ) {
+					errno = 0;
+					bail_out(EXIT_FAILURE,"<threads> has to be a number between 1 and %d", STRATEGY_MAX_THREADS);
+				}
+				break;
+
+			default:
+				bail_out(EXIT_FAILURE,"Usage: %s [-s minimax|entropy] [-j threads] <tree-file>",progname);
+		}
+	}
+
+	/* a random strategy would give a different tree every time */
+	if( options->strategy == STRATEGY_RANDOM ) {
+		bail_out(EXIT_FAILURE,"The strategy of a tree has to be minimax or entropy");
+	}
+
+	/* one thread per cpu if the number of threads was not specified */
+	if( options->threads == 0 ) {
+		options->threads = sysconf(_SC_NPROCESSORS_ONLN);
+		if( options->threads < 1 ) {
+			options->threads = 1;
+		} else if( options->threads > STRATEGY_MAX_THREADS ) {
+			options->threads = STRATEGY_MAX_THREADS;
+		}
+	}
+
+	if( argc - optind != 1 ) {
+		bail_out(EXIT_FAILURE,"Usage: %s [-s minimax|entropy] [-j threads] <tree-file>",progname);
+	}
+
+	options->file = argv[optind];
+}
+
+static void bail_out(int exitcode, const char *fmt, ...) {
+	va_list arguments;
+
+	(void) fprintf( stderr, "%s: ", progname );
+	if( fmt != NULL ) {
+		va_start(arguments,fmt);
+		(void) vfprintf( stderr, fmt, arguments );
+		va_end(arguments);
+	}
+
+	if(errno != 0) {
+		(void) fprintf( stderr, ": %s", strerror(errno) );
+	}
+	(void) fprintf( stderr, "\n" );
+
+	free_resources();
+	exit(exitcode);
+}
+
+static void free_resources(void) {
+	strategy_free();
+	free(nodes);
+	nodes = NULL;
+}
@@ -0,0 +1,103 @@
+/*
+ * This header file does contain the scoring of a guess which is shared by
+ * the server and the client. A code has 3 bits per slot, the first slot in
+ * the lowest bits, and the answer is computed on the packed code without
+ * any branches: the reds by comparing all slots at once, the whites from a
+ * nibble per color which counts the slots of the color.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#ifndef MASTERMIND_H
+#define MASTERMIND_H
+
+#include <stdint.h>
+
+/* === Constants === */
+
+#define SLOTS (5)
+#define COLORS (8)
+
+#define SHIFT_WIDTH (3)
+#define COLOR_MASK (7)
+#define PARITY_BIT (15)
+
+/* the bits of all slots of a code */
+#define CODE_MASK (0x7FFF)
+
+/* number of codes and of the 64 bit words of a set of codes */
+#define CODES (1 << (SLOTS * SHIFT_WIDTH))
+#define CODE_WORDS (CODES / 64)
+
+/* number of different answers, the reds and whites take 6 bits */
+#define ANSWERS (64)
+
+/* the lowest bit of every slot */
+#define SLOT_LOW_BITS (0x1249)
+
+/* the lowest and the highest bit of every nibble of the color counts */
+#define NIBBLE_LOW_BITS (0x11111111u)
+#define NIBBLE_HIGH_BITS (0x88888888u)
+
+/* === Implementations === */
+
+/**
+ * @brief returns a nibble per color with the number of slots of the code which have this color
+ * @param code the code, the parity bit is ignored
+ * @return the counts, the count of color c is in the bits 4c to 4c + 3
+ */
+static inline uint32_t mastermind_color_counts(uint16_t code) {
+	return (UINT32_C(1) << (4 * (code & COLOR_MASK)))
+	     + (UINT32_C(1) << (4 * ((code >> (SHIFT_WIDTH * 1)) & COLOR_MASK)))
+	     + (UINT32_C(1) << (4 * ((code >> (SHIFT_WIDTH * 2)) & COLOR_MASK)))
+	     + (UINT32_C(1) << (4 * ((code >> (SHIFT_WIDTH * 3)) & COLOR_MASK)))
+	     + (UINT32_C(1) << (4 * ((code >> (SHIFT_WIDTH * 4)) & COLOR_MASK)));
+}
+
+/**
+ * @brief computes the answer to a guess whose color counts are already known
+ * @param guess the guessed code, the parity bit is ignored
+ * @param guessed the color counts of the guess, see mastermind_color_counts
+ * @param secret the secret code
+ * @param hidden the color counts of the secret
+ * @return the reds in the lowest 3 bits and the whites in the 3 bits above, like the response of the server
+ */
+static inline uint8_t mastermind_answer_counted(uint16_t guess, uint32_t guessed, uint16_t secret, uint32_t hidden) {
+	/* a slot is no red if any of its bits differ, which is collected in its lowest bit */
+	const uint32_t diff = (uint32_t)(guess ^ secret) & CODE_MASK;
+	const uint32_t differs = (diff | (diff >> 1) | (diff >> 2)) & SLOT_LOW_BITS;
+	const uint32_t red = SLOTS - (uint32_t) __builtin_popcount( differs );
+
+	/* every color matches min(guessed, secret) times, a count is at most 5,
+	   so the highest bit of a nibble keeps the borrow of guessed - secret */
+	const uint32_t greater = (((guessed | NIBBLE_HIGH_BITS) - hidden) & NIBBLE_HIGH_BITS) >> 3;
+	const uint32_t mask    = greater * 0xF;
+	const uint32_t minimum = (hidden & mask) | (guessed & ~mask);
+
+	/* the sum of all nibbles ends in the highest one, it is at most 5 */
+	const uint32_t matches = (minimum * NIBBLE_LOW_BITS) >> 28;
+
+	return (uint8_t)(red | ((matches - red) << SHIFT_WIDTH));
+}
+
+/**
+ * @brief computes the answer to a guess
+ * @param guess the guessed code, the parity bit is ignored
+ * @param secret the secret code
+ * @return the reds in the lowest 3 bits and the whites in the 3 bits above, like the response of the server
+ */
+static inline uint8_t mastermind_answer(uint16_t guess, uint16_t secret) {
+	return mastermind_answer_counted( guess, mastermind_color_counts( guess ),
+	                                  secret, mastermind_color_counts( secret ) );
+}
+
+/**
+ * @brief returns the parity of the colors of the code
+ * @param code the code, the parity bit is ignored
+ * @return 1 if an odd number of bits is set otherwise 0
+ */
+static inline uint16_t mastermind_parity(uint16_t code) {
+	return (uint16_t)(__builtin_popcount( code & CODE_MASK ) & 1);
+}
+
+#endif
@@ -30,25 +30,63 @@
 #include <errno.h>
 #include <limits.h>
 #include <netdb.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <poll.h>
+
+/* the io_uring backend needs multishot recv, which came with the kernel headers of 6.0 */
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+#endif
+#if defined(IORING_RECV_MULTISHOT) && defined(__NR_io_uring_setup)
+#define HAVE_IO_URING
+#endif
+
+#include "mastermind.h"
 
 /* === Constants === */
 
 #define MAX_TRIES (35)
-#define SLOTS (5)
-#define COLORS (8)
 
 #define READ_BYTES (2)
 #define WRITE_BYTES (1)
 #define BUFFER_BYTES (2)
-#define SHIFT_WIDTH (3)
 #define PARITY_ERR_BIT (6)
 #define GAME_LOST_ERR_BIT (7)
 
-#define EXIT_PARITY_ERROR (2)
-#define EXIT_GAME_LOST (3)
-#define EXIT_MULTIPLE_ERRORS (4)
+#define BACKLOG (SOMAXCONN)
+
+/* Maximum number of events handled per epoll_wait call */
+#define MAX_EVENTS (256)
+
+/* Initial number of entries of the game table, it grows with the file descriptors */
+#define INITIAL_GAMES (64)
+
+/* Maximum number of event loop threads */
+#define MAX_THREADS (1024)
 
-#define BACKLOG (5)
+/* Size of the submission and the completion queue of an io_uring */
+#define URING_ENTRIES (256)
+#define URING_CQ_ENTRIES (4096)
+
+/* Provided buffers which the kernel fills with received data, a request only has 2 bytes */
+#define URING_BUFFERS (1024)
+#define URING_BUFFER_SIZE (64)
+#define URING_BUFFER_GROUP (0)
+
+/* Kinds of io_uring requests, stored in the user data together with the connection */
+#define URING_ACCEPT (1)
+#define URING_RECV (2)
+#define URING_SEND (3)
+#define URING_WAKE (4)
+
+/* Bits of the user data which store the generation of the game */
+#define URING_GENERATION_MASK (0xffffffu)
 
 
 /* === Macros === */
@@ -62,16 +100,34 @@
 /* Length of an array */
 #define COUNT_OF(x) (sizeof(x)/sizeof(x[0]))
 
+/* User data of an io_uring request: kind in the highest byte, generation and file descriptor */
+#define URING_DATA(kind, gen, fd) (((uint64_t)(kind) << 56) \
+    | ((uint64_t)((gen) & URING_GENERATION_MASK) << 32) | (uint32_t)(fd))
+#define URING_DATA_KIND(data) ((int)((data) >> 56))
+#define URING_DATA_GENERATION(data) ((uint32_t)((data) >> 32) & URING_GENERATION_MASK)
+#define URING_DATA_FD(data) ((int)(uint32_t)(data))
+
 /* === Global Variables === */
 
 /* Name of the program */
 static const char *progname = "server"; /* default name */
 
-/* File descriptor for server socket */
-static int sockfd = -1;
+/* The event loops, the first one is run by the main thread */
+static struct reactor *reactors = NULL;
+static long int reactor_count = 0;
+
+/* Written once the server stops, the read end is watched by all event loops */
+static int wake_pipe[2] = { -1, -1 };
+
+/* Signal mask while waiting for events, SIGINT and SIGTERM are blocked otherwise */
+static sigset_t waiting_mask;
+
+/* 1 if the event loops should use io_uring instead of epoll */
+static int use_uring = 0;
 
-/* File descriptor for connection socket */
-static int connfd = -1;
+/* Every possible response, a send of io_uring reads its byte after the
+   submission and the game table may have moved by then */
+static uint8_t response_bytes[256];
 
 /* This variable is set upon receipt of a signal */
 volatile sig_atomic_t quit = 0;
@@ -81,7 +137,87 @@ volatile sig_atomic_t quit = 0;
 
 struct opts {
     long int portno;
-    uint8_t secret[SLOTS];
+    long int threads;
+    int uring;
+    uint16_t secret;
+};
+
+/**
+ * @brief State of the game of a single connection
+ */
+struct game {
+    /* File descriptor of the connection, -1 if the entry is unused */
+    int fd;
+    /* Number of the last round which was played */
+    int round;
+    uint16_t secret;
+    /* The request of the next round, it may arrive in several parts */
+    uint8_t buffer[BUFFER_BYTES];
+    size_t received;
+    /* The response of the last round */
+    uint8_t response;
+    /* 1 if the response could not be sent yet because the socket was full */
+    int pending;
+    /* 1 if the game is over, the connection is closed once the response is sent */
+    int over;
+    /* io_uring only: counts the games of this entry, completions of an older game are ignored */
+    uint32_t generation;
+    /* io_uring only: received bytes which were not played yet, a round
+       is only played once the response of the last one was sent */
+    uint8_t input[READ_BYTES * MAX_TRIES];
+    size_t input_size;
+    /* io_uring only: 1 if the client closed its side, the received rounds are still played */
+    int closed;
+};
+
+#ifdef HAVE_IO_URING
+/**
+ * @brief The mapped rings of an io_uring instance and its provided buffers
+ */
+struct uring {
+    int fd;
+    /* the submission and the completion queue share a single mapping */
+    void *rings;
+    size_t rings_size;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+    /* entries up to sqe_tail are queued, they are submitted with the next io_uring_enter */
+    unsigned sqe_tail;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned sq_mask;
+    unsigned sq_entries;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned cq_mask;
+    struct io_uring_cqe *cqes;
+    /* the ring of provided buffers and the memory of the buffers */
+    struct io_uring_buf_ring *buf_ring;
+    size_t buf_ring_size;
+    uint8_t *buffers;
+    uint16_t buf_tail;
+};
+#endif
+
+/**
+ * @brief An event loop with its own listening socket, no state is shared between them
+ */
+struct reactor {
+    pthread_t thread;
+    /* 1 if the event loop runs in its own thread */
+    int started;
+    /* 1 if the event loop stopped because of an error */
+    int failed;
+    /* File descriptor for server socket */
+    int sockfd;
+    /* File descriptor of the epoll instance */
+    int epfd;
+    /* The games of all connections, indexed by the file descriptor of the connection */
+    struct game *games;
+    size_t games_size;
+    uint16_t secret;
+    /* The io_uring instance, NULL if the event loop uses epoll */
+    struct uring *uring;
 };
 
 
@@ -98,23 +234,204 @@ static void parse_args(int argc, char **argv, struct opts *options);
 /**
  * @brief Read message from socket
  *
- * This code *illustrates* one way to deal with partial reads
+ * The socket is non-blocking, so a message may arrive in several calls.
+ * The bytes which were received so far stay in buffer and are counted in
+ * bytes_recv, which is reset once the message is complete.
  *
  * @param sockfd_con Socket to read from
  * @param buffer Buffer where read data is stored
+ * @param bytes_recv Number of bytes of the message which were received before
  * @param n Size to read
- * @return Pointer to buffer on success, else NULL
+ * @return Pointer to buffer once all n bytes were received, else NULL. errno
+ * is EAGAIN if the rest of the message did not arrive yet and 0 if the
+ * connection was closed
  */
-static uint8_t *read_from_client(int sockfd_con, uint8_t *buffer, size_t n);
+static uint8_t *read_from_client(int sockfd_con, uint8_t *buffer, size_t *bytes_recv, size_t n);
 
 /**
  * @brief Compute answer to request
  * @param req Client's guess
  * @param resp Buffer that will be sent to the client
- * @param secret The server's secret
+ * @param secret The server's secret, packed like a request
  * @return Number of correct matches on success; -1 in case of a parity error
  */
-static int compute_answer(uint16_t req, uint8_t *resp, uint8_t *secret);
+static int compute_answer(uint16_t req, uint8_t *resp, uint16_t secret);
+
+/**
+ * @brief Create the non-blocking listening socket and the epoll instance of the event loop
+ * @param reactor The event loop
+ * @param portno The port on which the server listens
+ * @param reuseport 1 if other sockets may listen on the same port (SO_REUSEPORT)
+ */
+static void setup_reactor(struct reactor *reactor, long int portno, int reuseport);
+
+/**
+ * @brief Run the event loop until the server is stopped
+ * @param argument The reactor
+ * @return Always NULL
+ */
+static void *run_reactor(void *argument);
+
+/**
+ * @brief Wait for events with epoll and handle them until the server is stopped
+ * @param reactor The event loop
+ */
+static void run_epoll(struct reactor *reactor);
+
+/**
+ * @brief Handle the connections with io_uring until the server is stopped
+ *
+ * Accept, recv and send are submitted to the ring, everything which was
+ * queued while handling the completions is submitted with the next wait,
+ * so an event loop iteration needs a single system call. The listening
+ * socket has a multishot accept and every connection a multishot recv
+ * into the provided buffers of the ring.
+ *
+ * @param reactor The event loop
+ * @return 0 once the server was stopped, -1 if io_uring is not available
+ */
+static int run_uring(struct reactor *reactor);
+
+/**
+ * @brief Wake all event loops, so they notice that quit is set
+ */
+static void wake_reactors(void);
+
+/**
+ * @brief Accept all pending connections and start a game for each of them
+ * @param reactor The event loop of the listening socket
+ */
+static void accept_clients(struct reactor *reactor);
+
+/**
+ * @brief Add the connection to the game table and the epoll instance
+ * @param reactor The event loop which plays the game
+ * @param fd The connection socket
+ * @return 0 on success, -1 on error
+ */
+static int start_game(struct reactor *reactor, int fd);
+
+/**
+ * @brief Continue the game after an event of its connection
+ * @param game The game of the connection
+ */
+static void handle_client(struct game *game);
+
+/**
+ * @brief Compute the response to the received request
+ * @param game The game with the complete request in its buffer
+ */
+static void play_round(struct game *game);
+
+/**
+ * @brief Send the response of the last round
+ * @param game The game with the response
+ * @return 0 if it was sent or the socket is full (the game stays pending), -1 on error
+ */
+static int send_response(struct game *game);
+
+/**
+ * @brief Close the connection of the game
+ * @param game The game which is over
+ */
+static void end_game(struct game *game);
+
+#ifdef HAVE_IO_URING
+/**
+ * @brief Create the ring, map its queues and register the provided buffers
+ * @param ring The ring which is set up
+ * @return 0 on success, -1 on error with errno set
+ */
+static int uring_setup(struct uring *ring);
+
+/**
+ * @brief Unmap the queues and the buffers and close the ring
+ * @param ring The ring, it may be set up partially
+ */
+static void uring_free(struct uring *ring);
+
+/**
+ * @brief Get a free entry of the submission queue, full queues are submitted first
+ * @param ring The ring
+ * @return The cleared entry, NULL if the queue could not be submitted
+ */
+static struct io_uring_sqe *uring_get_sqe(struct uring *ring);
+
+/**
+ * @brief Submit the queued entries and wait for a completion if requested
+ * @param ring The ring
+ * @param wait 1 if at least one completion should be waited for
+ * @return The number of submitted entries, -1 on error
+ */
+static int uring_enter(struct uring *ring, int wait);
+
+/**
+ * @brief Handle all completions of the ring
+ * @param reactor The event loop of the ring
+ */
+static void uring_reap(struct reactor *reactor);
+
+/**
+ * @brief Queue a request
+ * @param ring The ring
+ * @param opcode The operation
+ * @param fd The file descriptor of the operation
+ * @param user_data The user data of the completion
+ * @return The entry which may be completed by the caller, NULL on error
+ */
+static struct io_uring_sqe *uring_prepare(struct uring *ring, uint8_t opcode, int fd, uint64_t user_data);
+
+/**
+ * @brief Queue a multishot accept of the listening socket
+ * @param ring The ring
+ * @param sockfd The listening socket
+ * @return 0 on success, -1 on error
+ */
+static int uring_accept(struct uring *ring, int sockfd);
+
+/**
+ * @brief Queue a multishot recv of the connection into the provided buffers
+ * @param reactor The event loop of the game
+ * @param game The game
+ * @return 0 on success, -1 on error
+ */
+static int uring_recv(struct reactor *reactor, struct game *game);
+
+/**
+ * @brief Handle a completion of the recv of a connection
+ * @param reactor The event loop of the game
+ * @param game The game, NULL if it has already ended
+ * @param cqe The completion
+ */
+static void uring_received(struct reactor *reactor, struct game *game, struct io_uring_cqe *cqe);
+
+/**
+ * @brief Play the next round if it was received and the last response was sent
+ * @param reactor The event loop of the game
+ * @param game The game
+ */
+static void uring_next_round(struct reactor *reactor, struct game *game);
+
+/**
+ * @brief Give a provided buffer back to the kernel
+ * @param ring The ring
+ * @param bid The id of the buffer
+ */
+static void uring_recycle(struct uring *ring, uint16_t bid);
+
+/**
+ * @brief Close the connection of the game, its multishot recv is stopped first
+ * @param game The game which is over
+ */
+static void uring_end_game(struct game *game);
+#endif
+
+/**
+ * @brief Set the O_NONBLOCK flag of the file descriptor
+ * @param fd The file descriptor
+ * @return 0 on success, -1 on error
+ */
+static int set_nonblocking(int fd);
 
 /**
  * @brief terminate program on program error
@@ -137,71 +454,49 @@ static void free_resources(void);
 
 /* === Implementations === */
 
-static uint8_t *read_from_client(int fd, uint8_t *buffer, size_t n)
+static uint8_t *read_from_client(int fd, uint8_t *buffer, size_t *bytes_recv, size_t n)
 {
     /* loop, as packet can arrive in several partial reads */
-    size_t bytes_recv = 0;
-    do {
+    while (*bytes_recv < n) {
         ssize_t r;
-        r = recv(fd, buffer + bytes_recv, n - bytes_recv, 0);
+        r = recv(fd, buffer + *bytes_recv, n - *bytes_recv, 0);
+        if (r < 0 && errno == EINTR) {
+            continue;
+        }
+        if (r == 0) {
+            errno = 0; /* connection closed */
+        }
         if (r <= 0) {
             return NULL;
         }
-        bytes_recv += r;
-    } while (bytes_recv < n);
-
-    if (bytes_recv < n) {
-        return NULL;
+        *bytes_recv += r;
     }
+
+    *bytes_recv = 0;
     return buffer;
 }
 
-static int compute_answer(uint16_t req, uint8_t *resp, uint8_t *secret)
+static int compute_answer(uint16_t req, uint8_t *resp, uint16_t secret)
 {
-    int colors_left[COLORS];
-    int guess[COLORS];
+    uint16_t guess;
     uint8_t parity_calc, parity_recv;
-    int red, white;
-    int j;
-
-    parity_recv = (req >> 15) & 1;
-
-    /* extract the guess and calculate parity */
-    parity_calc = 0;
-    for (j = 0; j < SLOTS; ++j) {
-        int tmp = req & 0x7;
-        parity_calc ^= tmp ^ (tmp >> 1) ^ (tmp >> 2);
-        guess[j] = tmp;
-        req >>= SHIFT_WIDTH;
-    }
-    parity_calc &= 0x1;
-
-    /* marking red and white */
-    (void) memset(&colors_left[0], 0, sizeof(colors_left));
-    red = white = 0;
-    for (j = 0; j < SLOTS; ++j) {
-        /* mark red */
-        if (guess[j] == secret[j]) {
-            red++;
-        } else {
-            colors_left[secret[j]]++;
-        }
-    }
-    for (j = 0; j < SLOTS; ++j) {
-        /* not marked red */
-        if (guess[j] != secret[j]) {
-            if (colors_left[guess[j]] > 0) {
-                white++;
-                colors_left[guess[j]]--;
-            }
-        }
-    }
+    int red;
+
+    parity_recv = (req >> PARITY_BIT) & 1;
+
+    /* the slots are compared in the packed code, see mastermind.h */
+    guess = req & CODE_MASK;
+    parity_calc = mastermind_parity(guess);
+    resp[0] = mastermind_answer(guess, secret);
 
-	DEBUG("%d%d%d%d%d Red=%d White=%d parity=%d\n", guess[0], guess[1], guess[2], guess[3], guess[4], red, white, parity_calc);
+    red = resp[0] & COLOR_MASK;
+
+	DEBUG("%d%d%d%d%d Red=%d White=%d parity=%d\n", guess & COLOR_MASK,
+	      (guess >> (SHIFT_WIDTH * 1)) & COLOR_MASK, (guess >> (SHIFT_WIDTH * 2)) & COLOR_MASK,
+	      (guess >> (SHIFT_WIDTH * 3)) & COLOR_MASK, (guess >> (SHIFT_WIDTH * 4)) & COLOR_MASK,
+	      red, (resp[0] >> SHIFT_WIDTH) & COLOR_MASK, parity_calc);
 
     /* build response buffer */
-    resp[0] = red;
-    resp[0] |= (white << SHIFT_WIDTH);
     if (parity_recv != parity_calc) {
         resp[0] |= (1 << PARITY_ERR_BIT);
 	DEBUG("Parity Error\n");
@@ -234,11 +529,37 @@ static void free_resources(void)
 {
     /* clean up resources */
     DEBUG("Shutting down server\n");
-    if(connfd >= 0) {
-        (void) close(connfd);
+    for (long int r = 0; r < reactor_count; r++) {
+        struct reactor *reactor = &reactors[r];
+
+        for (size_t i = 0; i < reactor->games_size; i++) {
+            if (reactor->games[i].fd >= 0) {
+                (void) close(reactor->games[i].fd);
+            }
+        }
+        free(reactor->games);
+
+#ifdef HAVE_IO_URING
+        if (reactor->uring != NULL) {
+            uring_free(reactor->uring);
+            free(reactor->uring);
+        }
+#endif
+        if(reactor->epfd >= 0) {
+            (void) close(reactor->epfd);
+        }
+        if(reactor->sockfd >= 0) {
+            (void) close(reactor->sockfd);
+        }
     }
-    if(sockfd >= 0) {
-        (void) close(sockfd);
+    free(reactors);
+    reactors = NULL;
+    reactor_count = 0;
+
+    for (int i = 0; i < 2; i++) {
+        if (wake_pipe[i] >= 0) {
+            (void) close(wake_pipe[i]);
+        }
     }
 }
 
@@ -251,19 +572,24 @@ static void signal_handler(int sig)
  * @brief Program entry point
  * @param argc The argument counter
  * @param argv The argument vector
- * @return EXIT_SUCCESS on success, EXIT_PARITY_ERROR in case of an parity
- * error, EXIT_GAME_LOST in case client needed to many guesses,
- * EXIT_MULTIPLE_ERRORS in case multiple errors occured in one round
+ * @return EXIT_SUCCESS once the server was stopped by a signal, EXIT_FAILURE
+ * if an event loop failed. The server plays many games, so the end of a game
+ * is not an exit code: a won game prints its rounds on stdout, a parity error
+ * or a lost game is printed on stderr, several errors in the last round
+ * print all of them
  */
 int main(int argc, char *argv[])
 {
 	DEBUG("Server started in with DEBUG Build!\n");
     struct opts options;
-    int round;
-    int ret;
 
     parse_args(argc, argv, &options);
 
+    use_uring = options.uring;
+    for (int i = 0; i < COUNT_OF(response_bytes); i++) {
+        response_bytes[i] = i;
+    }
+
     /* setup signal handlers */
     const int signals[] = {SIGINT, SIGTERM};
     struct sigaction s;
@@ -281,121 +607,790 @@ int main(int argc, char *argv[])
 
 
 
+    /* the signals are only delivered while waiting for events, so a
+       signal can not get lost between the check of quit and epoll_wait.
+       The threads inherit the blocked signals. */
+    sigset_t blocked;
+    (void) sigemptyset(&blocked);
+    for(int i = 0; i < COUNT_OF(signals); i++) {
+        (void) sigaddset(&blocked, signals[i]);
+    }
+    if (sigprocmask(SIG_BLOCK, &blocked, &waiting_mask) < 0) {
+        bail_out(EXIT_FAILURE, "sigprocmask");
+    }
+
+    if (pipe(wake_pipe) < 0) {
+        bail_out(EXIT_FAILURE, "pipe");
+    }
+    if (set_nonblocking(wake_pipe[1]) < 0) {
+        bail_out(EXIT_FAILURE, "fcntl(O_NONBLOCK)");
+    }
+
+    reactors = calloc(options.threads, sizeof(struct reactor));
+    if (reactors == NULL) {
+        bail_out(EXIT_FAILURE, "calloc");
+    }
+
+    /* all sockets are bound before the first connection is accepted */
+    for (long int i = 0; i < options.threads; i++) {
+        reactors[i].sockfd = -1;
+        reactors[i].epfd   = -1;
+        reactors[i].secret = options.secret;
+        reactor_count++;
+
+        setup_reactor(&reactors[i], options.portno, options.threads > 1);
+    }
+
+    /* the kernel distributes the connections among the listening sockets */
+    for (long int i = 1; i < reactor_count; i++) {
+        if (pthread_create(&reactors[i].thread, NULL, run_reactor, &reactors[i]) != 0) {
+            (void) fprintf(stderr, "%s: Unable to start thread %ld, using %ld threads\n", progname, i, i);
+
+            /* a socket without event loop must not get any connections */
+            for (long int j = i; j < reactor_count; j++) {
+                (void) close(reactors[j].sockfd);
+                reactors[j].sockfd = -1;
+            }
+            break;
+        }
+        reactors[i].started = 1;
+    }
+
+    (void) run_reactor(&reactors[0]);
+
+    int ret = reactors[0].failed ? EXIT_FAILURE : EXIT_SUCCESS;
+    for (long int i = 1; i < reactor_count; i++) {
+        if (reactors[i].started) {
+            (void) pthread_join(reactors[i].thread, NULL);
+            if (reactors[i].failed) {
+                ret = EXIT_FAILURE;
+            }
+        }
+    }
+
+    /* we are done */
+    free_resources();
+    return ret;
+}
+
+static void setup_reactor(struct reactor *reactor, long int portno, int reuseport)
+{
     /* Create a new TCP/IP socket `sockfd`, and set the SO_REUSEADDR
-       option for this socket. Then bind the socket to localhost:portno,
-       listen, and wait for new connections, which should be assigned to
-       `connfd`. Terminate the program in case of an error.
+       option for this socket. Then bind the socket to localhost:portno
+       and listen for new connections. The socket is non-blocking, so
+       the connections can be accepted from the event loop. Terminate
+       the program in case of an error.
     */
-	struct addrinfo hints;
-	struct addrinfo *ai, *aip;
-	char portStr[12];	
-		
-	memset(&hints, 0, sizeof(hints));
-	hints.ai_family		= AF_INET;
-	hints.ai_socktype	= SOCK_STREAM;
-	hints.ai_flags		= AI_PASSIVE;
-	
-	memset(&portStr,0,sizeof(portStr));
-	if( snprintf(portStr,12,"%ld",options.portno) < 0 ){
-		 bail_out(EXIT_FAILURE, "snprintf( portno )");
-	}
-	
-	if( getaddrinfo(NULL,portStr,&hints,&ai) < 0 ) {
-		bail_out(EXIT_FAILURE, "getaddrinfo");
-	}
-
-	aip = ai;
-	sockfd = socket(aip->ai_family, aip->ai_socktype, aip->ai_protocol);
-	if( sockfd < 0 ) {
-		freeaddrinfo(ai);
-		bail_out(EXIT_FAILURE, "socket");
-	}
-
-	if( setsockopt(sockfd,SOL_SOCKET,SO_REUSEADDR, &(int){1}, sizeof(int)) < 0 ) {
-		freeaddrinfo(ai);
-		bail_out(EXIT_FAILURE, "setsockopt(SO_REUSEADDR)");
-	}
-
-	if( bind(sockfd, aip->ai_addr, aip->ai_addrlen) < 0 ) {
-		freeaddrinfo(ai);		
-		bail_out(EXIT_FAILURE, "bind");
-	}
-
-	freeaddrinfo(ai);
-	 
-	if( listen(sockfd,5) < 0 ) {
-		bail_out(EXIT_FAILURE, "listen");
-	}
-	
-	struct sockaddr_in client_addr;
-	socklen_t client_addrLen = sizeof(client_addr);
-	memset(&client_addr,0,client_addrLen);
-	
-	connfd = accept(sockfd, (struct sockaddr*)&client_addr, &client_addrLen);
-	if( connfd < 0 ) {
-		bail_out(EXIT_FAILURE, "accept");
-	}
-	
-    /* accepted the connection */
-    ret = EXIT_SUCCESS;
-    for (round = 1; round <= MAX_TRIES && !quit; ++round) {
-        uint16_t request;
-        static uint8_t buffer[BUFFER_BYTES];
-        int correct_guesses;
-        int error = 0;
-
-        /* read from client */
-        if (read_from_client(connfd, &buffer[0], READ_BYTES) == NULL) {
-            if (quit) break; /* caught signal */
-            bail_out(EXIT_FAILURE, "read_from_client");
-        }
-        request = (buffer[1] << 8) | buffer[0];
-        DEBUG("Round %d: Received 0x%x\n", round, request);
-
-        /* compute answer */
-        correct_guesses = compute_answer(request, buffer, options.secret);
-        if (round == MAX_TRIES && correct_guesses != SLOTS) {
-            buffer[0] |= 1 << GAME_LOST_ERR_BIT;
-        }
-
-        DEBUG("Sending byte 0x%x\n", buffer[0]);
-
-        /* send message to client */
-        send(connfd, &buffer[0], WRITE_BYTES, 0);
-
-        /* We sent the answer to the client; now stop the game
-           if its over, or an error occured */
-        if (*buffer & (1<<PARITY_ERR_BIT)) {
-            (void) fprintf(stderr, "Parity error\n");
-            error = 1;
-            ret = EXIT_PARITY_ERROR;
-        }
-        if (*buffer & (1 << GAME_LOST_ERR_BIT)) {
-            (void) fprintf(stderr, "Game lost\n");
-            error = 1;
-            if (ret == EXIT_PARITY_ERROR) {
-                ret = EXIT_MULTIPLE_ERRORS;
-            } else {
-                ret = EXIT_GAME_LOST;
+    struct addrinfo hints;
+    struct addrinfo *ai, *aip;
+    char portStr[12];
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family     = AF_INET;
+    hints.ai_socktype   = SOCK_STREAM;
+    hints.ai_flags      = AI_PASSIVE;
+
+    memset(&portStr,0,sizeof(portStr));
+    if( snprintf(portStr,12,"%ld",portno) < 0 ){
+         bail_out(EXIT_FAILURE, "snprintf( portno )");
+    }
+
+    if( getaddrinfo(NULL,portStr,&hints,&ai) < 0 ) {
+        bail_out(EXIT_FAILURE, "getaddrinfo");
+    }
+
+    aip = ai;
+    reactor->sockfd = socket(aip->ai_family, aip->ai_socktype, aip->ai_protocol);
+    if( reactor->sockfd < 0 ) {
+        freeaddrinfo(ai);
+        bail_out(EXIT_FAILURE, "socket");
+    }
+
+    if( setsockopt(reactor->sockfd,SOL_SOCKET,SO_REUSEADDR, &(int){1}, sizeof(int)) < 0 ) {
+        freeaddrinfo(ai);
+        bail_out(EXIT_FAILURE, "setsockopt(SO_REUSEADDR)");
+    }
+
+    /* every event loop has its own socket on the same port */
+    if( reuseport && setsockopt(reactor->sockfd,SOL_SOCKET,SO_REUSEPORT, &(int){1}, sizeof(int)) < 0 ) {
+        freeaddrinfo(ai);
+        bail_out(EXIT_FAILURE, "setsockopt(SO_REUSEPORT)");
+    }
+
+    if( bind(reactor->sockfd, aip->ai_addr, aip->ai_addrlen) < 0 ) {
+        freeaddrinfo(ai);
+        bail_out(EXIT_FAILURE, "bind");
+    }
+
+    freeaddrinfo(ai);
+
+    if( set_nonblocking(reactor->sockfd) < 0 ) {
+        bail_out(EXIT_FAILURE, "fcntl(O_NONBLOCK)");
+    }
+
+    if( listen(reactor->sockfd,BACKLOG) < 0 ) {
+        bail_out(EXIT_FAILURE, "listen");
+    }
+
+    reactor->epfd = epoll_create1(0);
+    if (reactor->epfd < 0) {
+        bail_out(EXIT_FAILURE, "epoll_create1");
+    }
+
+    struct epoll_event listen_event;
+    listen_event.events  = EPOLLIN | EPOLLET;
+    listen_event.data.fd = reactor->sockfd;
+    if (epoll_ctl(reactor->epfd, EPOLL_CTL_ADD, reactor->sockfd, &listen_event) < 0) {
+        bail_out(EXIT_FAILURE, "epoll_ctl");
+    }
+
+    /* the pipe stays readable once it was written, so it wakes every event loop */
+    struct epoll_event wake_event;
+    wake_event.events  = EPOLLIN;
+    wake_event.data.fd = wake_pipe[0];
+    if (epoll_ctl(reactor->epfd, EPOLL_CTL_ADD, wake_pipe[0], &wake_event) < 0) {
+        bail_out(EXIT_FAILURE, "epoll_ctl");
+    }
+}
+
+static void *run_reactor(void *argument)
+{
+    struct reactor *reactor = argument;
+
+    /* the ring is created by the thread which submits to it */
+    if (!use_uring || run_uring(reactor) < 0) {
+        run_epoll(reactor);
+    }
+
+    /* the signal was only delivered to one of the event loops */
+    wake_reactors();
+    return NULL;
+}
+
+static void run_epoll(struct reactor *reactor)
+{
+    /* every connection plays its own game until the server is stopped */
+    while (!quit) {
+        struct epoll_event events[MAX_EVENTS];
+        int count = epoll_pwait(reactor->epfd, events, MAX_EVENTS, -1, &waiting_mask);
+        if (count < 0) {
+            if (errno == EINTR) continue; /* caught signal */
+            (void) fprintf(stderr, "%s: epoll_wait: %s\n", progname, strerror(errno));
+            reactor->failed = 1;
+            quit = 1;
+            break;
+        }
+
+        for (int i = 0; i < count; i++) {
+            int fd = events[i].data.fd;
+
+            if (fd == reactor->sockfd) {
+                accept_clients(reactor);
+            } else if (fd != wake_pipe[0] && (size_t) fd < reactor->games_size && reactor->games[fd].fd == fd) {
+                /* the game may have been closed by an earlier event of this call */
+                handle_client(&reactor->games[fd]);
+            }
+        }
+    }
+}
+
+static void wake_reactors(void)
+{
+    const char wake = 0;
+    (void) write(wake_pipe[1], &wake, 1);
+}
+
+static void accept_clients(struct reactor *reactor)
+{
+    /* the listening socket is edge-triggered, so accept until no connection is left */
+    while (1) {
+        int fd = accept(reactor->sockfd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                (void) fprintf(stderr, "%s: accept: %s\n", progname, strerror(errno));
             }
+            return;
+        }
+
+        if (start_game(reactor, fd) < 0) {
+            (void) fprintf(stderr, "%s: Unable to start a game: %s\n", progname, strerror(errno));
+            (void) close(fd);
         }
-        if (error) {
+    }
+}
+
+static int start_game(struct reactor *reactor, int fd)
+{
+    /* the table grows with the highest file descriptor */
+    if ((size_t) fd >= reactor->games_size) {
+        size_t size = reactor->games_size > 0 ? reactor->games_size : INITIAL_GAMES;
+        while (size <= (size_t) fd) {
+            size *= 2;
+        }
+
+        struct game *grown = realloc(reactor->games, size * sizeof(struct game));
+        if (grown == NULL) {
+            return -1;
+        }
+        for (size_t i = reactor->games_size; i < size; i++) {
+            grown[i].fd = -1;
+            grown[i].generation = 0;
+        }
+        reactor->games = grown;
+        reactor->games_size = size;
+    }
+
+    struct game *game = &reactor->games[fd];
+    game->fd         = fd;
+    game->round      = 0;
+    game->received   = 0;
+    game->response   = 0;
+    game->pending    = 0;
+    game->over       = 0;
+    game->input_size = 0;
+    game->closed     = 0;
+    game->generation = (game->generation + 1) & URING_GENERATION_MASK;
+    game->secret     = reactor->secret;
+
+#ifdef HAVE_IO_URING
+    if (reactor->uring != NULL) {
+        if (uring_recv(reactor, game) < 0) {
+            game->fd = -1;
+            return -1;
+        }
+        DEBUG("Connection %d: new game\n", fd);
+        return 0;
+    }
+#endif
+
+    if (set_nonblocking(fd) < 0) {
+        game->fd = -1;
+        return -1;
+    }
+
+    /* EPOLLOUT is only reported once the socket gets writable again */
+    struct epoll_event event;
+    event.events  = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.fd = fd;
+    if (epoll_ctl(reactor->epfd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        game->fd = -1;
+        return -1;
+    }
+
+    DEBUG("Connection %d: new game\n", fd);
+    return 0;
+}
+
+static void handle_client(struct game *game)
+{
+    /* the response of the last round has to be sent before the next guess is read */
+    if (game->pending && send_response(game) < 0) {
+        end_game(game);
+        return;
+    }
+    if (game->pending) {
+        return;
+    }
+    if (game->over) {
+        end_game(game);
+        return;
+    }
+
+    /* the socket is edge-triggered, so read until no complete request is left */
+    while (1) {
+        if (read_from_client(game->fd, game->buffer, &game->received, READ_BYTES) == NULL) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                DEBUG("Connection %d: closed by client\n", game->fd);
+                end_game(game);
+            }
+            return;
+        }
+
+        play_round(game);
+
+        if (send_response(game) < 0) {
+            end_game(game);
+            return;
+        }
+        if (game->pending) {
+            return; /* continued once the socket is writable */
+        }
+        if (game->over) {
+            end_game(game);
+            return;
+        }
+    }
+}
+
+static void play_round(struct game *game)
+{
+    uint16_t request;
+    int correct_guesses;
+
+    game->round++;
+    request = (game->buffer[1] << 8) | game->buffer[0];
+    DEBUG("Connection %d: Round %d: Received 0x%x\n", game->fd, game->round, request);
+
+    /* compute answer */
+    correct_guesses = compute_answer(request, &game->response, game->secret);
+    if (game->round == MAX_TRIES && correct_guesses != SLOTS) {
+        game->response |= 1 << GAME_LOST_ERR_BIT;
+    }
+
+    DEBUG("Sending byte 0x%x\n", game->response);
+    game->pending = 1;
+
+    /* stop the game once the answer is sent if its over, or an error occured */
+    if (game->response & (1 << PARITY_ERR_BIT)) {
+        (void) fprintf(stderr, "Parity error\n");
+        game->over = 1;
+    }
+    if (game->response & (1 << GAME_LOST_ERR_BIT)) {
+        (void) fprintf(stderr, "Game lost\n");
+        game->over = 1;
+    }
+    if (!game->over && correct_guesses == SLOTS) {
+        /* won */
+        (void) printf("Runden: %d\n", game->round);
+        game->over = 1;
+    }
+}
+
+static int send_response(struct game *game)
+{
+    ssize_t sent;
+
+    /* a client which closed its connection must not kill the server with SIGPIPE */
+    do {
+        sent = send(game->fd, &game->response, WRITE_BYTES, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+
+    if (sent < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+
+    game->pending = 0;
+    return 0;
+}
+
+static void end_game(struct game *game)
+{
+    DEBUG("Connection %d: game ended after %d rounds\n", game->fd, game->round);
+
+    /* closing the descriptor also removes it from the epoll instance */
+    (void) close(game->fd);
+    game->fd = -1;
+}
+
+#ifdef HAVE_IO_URING
+static int run_uring(struct reactor *reactor)
+{
+    struct uring *ring = calloc(1, sizeof(struct uring));
+    struct io_uring_sqe *sqe;
+
+    if (ring == NULL || uring_setup(ring) < 0) {
+        int error = ring == NULL ? ENOMEM : errno;
+
+        if (ring != NULL) {
+            uring_free(ring);
+            free(ring);
+        }
+        (void) fprintf(stderr, "%s: io_uring is not available, using epoll: %s\n", progname, strerror(error));
+        return -1;
+    }
+    reactor->uring = ring;
+
+    /* the pipe is only polled once, it stays readable once the server stops */
+    if (uring_accept(ring, reactor->sockfd) < 0
+        || (sqe = uring_prepare(ring, IORING_OP_POLL_ADD, wake_pipe[0],
+                                URING_DATA(URING_WAKE, 0, wake_pipe[0]))) == NULL) {
+        (void) fprintf(stderr, "%s: io_uring: %s\n", progname, strerror(errno));
+        reactor->failed = 1;
+        quit = 1;
+        return 0;
+    }
+    sqe->poll32_events = POLLIN;
+
+    /* every connection plays its own game until the server is stopped */
+    while (!quit) {
+        if (uring_enter(ring, 1) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            (void) fprintf(stderr, "%s: io_uring_enter: %s\n", progname, strerror(errno));
+            reactor->failed = 1;
+            quit = 1;
+            break;
+        }
+
+        uring_reap(reactor);
+    }
+
+    return 0;
+}
+
+static int uring_setup(struct uring *ring)
+{
+    struct io_uring_params params;
+    struct io_uring_buf_reg reg;
+
+    ring->fd = -1;
+
+    memset(&params, 0, sizeof(params));
+    params.flags      = IORING_SETUP_CQSIZE;
+    params.cq_entries = URING_CQ_ENTRIES;
+#if defined(IORING_SETUP_SINGLE_ISSUER) && defined(IORING_SETUP_DEFER_TASKRUN)
+    /* the completions are only processed while the event loop waits for them */
+    params.flags |= IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+#endif
+    ring->fd = syscall(__NR_io_uring_setup, URING_ENTRIES, &params);
+    if (ring->fd < 0 && errno == EINVAL) {
+        /* older kernels do not know all of the flags */
+        memset(&params, 0, sizeof(params));
+        params.flags      = IORING_SETUP_CQSIZE;
+        params.cq_entries = URING_CQ_ENTRIES;
+        ring->fd = syscall(__NR_io_uring_setup, URING_ENTRIES, &params);
+    }
+    if (ring->fd < 0) {
+        return -1;
+    }
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+        errno = ENOSYS;
+        return -1;
+    }
+
+    /* the submission queue and the completion queue share a single mapping */
+    size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->rings_size = sq_size > cq_size ? sq_size : cq_size;
+    ring->rings = mmap(NULL, ring->rings_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring->fd, IORING_OFF_SQ_RING);
+    if (ring->rings == MAP_FAILED) {
+        ring->rings = NULL;
+        return -1;
+    }
+
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        ring->sqes = NULL;
+        return -1;
+    }
+
+    uint8_t *rings = ring->rings;
+    ring->sq_head    = (unsigned *) (rings + params.sq_off.head);
+    ring->sq_tail    = (unsigned *) (rings + params.sq_off.tail);
+    ring->sq_mask    = *(unsigned *) (rings + params.sq_off.ring_mask);
+    ring->sq_entries = params.sq_entries;
+    ring->sqe_tail   = *ring->sq_tail;
+    ring->cq_head    = (unsigned *) (rings + params.cq_off.head);
+    ring->cq_tail    = (unsigned *) (rings + params.cq_off.tail);
+    ring->cq_mask    = *(unsigned *) (rings + params.cq_off.ring_mask);
+    ring->cqes       = (struct io_uring_cqe *) (rings + params.cq_off.cqes);
+
+    /* every entry is submitted at its own index, so the array never changes */
+    unsigned *array = (unsigned *) (rings + params.sq_off.array);
+    for (unsigned i = 0; i < params.sq_entries; i++) {
+        array[i] = i;
+    }
+
+    /* the ring of the provided buffers has to be page aligned */
+    ring->buf_ring_size = URING_BUFFERS * sizeof(struct io_uring_buf);
+    ring->buf_ring = mmap(NULL, ring->buf_ring_size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring->buf_ring == MAP_FAILED) {
+        ring->buf_ring = NULL;
+        return -1;
+    }
+
+    ring->buffers = malloc(URING_BUFFERS * URING_BUFFER_SIZE);
+    if (ring->buffers == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr    = (uintptr_t) ring->buf_ring;
+    reg.ring_entries = URING_BUFFERS;
+    reg.bgid         = URING_BUFFER_GROUP;
+    if (syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        return -1;
+    }
+
+    /* all buffers are handed to the kernel with the first submission */
+    for (unsigned bid = 0; bid < URING_BUFFERS; bid++) {
+        uring_recycle(ring, bid);
+    }
+
+    return 0;
+}
+
+static void uring_free(struct uring *ring)
+{
+    /* closing the ring cancels its requests, so the buffers are released last */
+    if (ring->fd >= 0) {
+        (void) close(ring->fd);
+    }
+    if (ring->rings != NULL) {
+        (void) munmap(ring->rings, ring->rings_size);
+    }
+    if (ring->sqes != NULL) {
+        (void) munmap(ring->sqes, ring->sqes_size);
+    }
+    if (ring->buf_ring != NULL) {
+        (void) munmap(ring->buf_ring, ring->buf_ring_size);
+    }
+    free(ring->buffers);
+}
+
+static struct io_uring_sqe *uring_get_sqe(struct uring *ring)
+{
+    if (ring->sqe_tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) == ring->sq_entries) {
+        /* the completions of the submitted entries are handled by the next reap */
+        if (uring_enter(ring, 0) < 0) {
+            return NULL;
+        }
+        if (ring->sqe_tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) == ring->sq_entries) {
+            errno = EBUSY;
+            return NULL;
+        }
+    }
+
+    struct io_uring_sqe *sqe = &ring->sqes[ring->sqe_tail & ring->sq_mask];
+    ring->sqe_tail++;
+
+    (void) memset(sqe, 0, sizeof(struct io_uring_sqe));
+    return sqe;
+}
+
+static int uring_enter(struct uring *ring, int wait)
+{
+    /* the queued entries and the recycled buffers are published together */
+    __atomic_store_n(ring->sq_tail, ring->sqe_tail, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->buf_ring->tail, ring->buf_tail, __ATOMIC_RELEASE);
+
+    unsigned submit = ring->sqe_tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+
+    /* like epoll_pwait the signals are only delivered while waiting */
+    return syscall(__NR_io_uring_enter, ring->fd, submit, wait ? 1 : 0,
+                   wait ? IORING_ENTER_GETEVENTS : 0, wait ? &waiting_mask : NULL, _NSIG / 8);
+}
+
+static void uring_reap(struct reactor *reactor)
+{
+    struct uring *ring = reactor->uring;
+    unsigned head = *ring->cq_head;
+    unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+
+    for (; head != tail; head++) {
+        struct io_uring_cqe *cqe = &ring->cqes[head & ring->cq_mask];
+        int fd = URING_DATA_FD(cqe->user_data);
+        struct game *game = NULL;
+
+        /* the completions of a game which has already ended are only cleaned up */
+        if (fd >= 0 && (size_t) fd < reactor->games_size && reactor->games[fd].fd == fd
+            && reactor->games[fd].generation == URING_DATA_GENERATION(cqe->user_data)) {
+            game = &reactor->games[fd];
+        }
+
+        switch (URING_DATA_KIND(cqe->user_data)) {
+        case URING_ACCEPT:
+            if (cqe->res >= 0 && start_game(reactor, cqe->res) < 0) {
+                (void) fprintf(stderr, "%s: Unable to start a game: %s\n", progname, strerror(errno));
+                (void) close(cqe->res);
+            } else if (cqe->res < 0 && cqe->res != -ECONNABORTED) {
+                (void) fprintf(stderr, "%s: accept: %s\n", progname, strerror(-cqe->res));
+            }
+
+            /* the multishot accept stops after an error */
+            if (!(cqe->flags & IORING_CQE_F_MORE) && uring_accept(ring, reactor->sockfd) < 0) {
+                (void) fprintf(stderr, "%s: io_uring: %s\n", progname, strerror(errno));
+                reactor->failed = 1;
+                quit = 1;
+            }
             break;
-        } else if (correct_guesses == SLOTS) {
-            /* won */
-            (void) printf("Runden: %d\n", round);
+
+        case URING_RECV:
+            uring_received(reactor, game, cqe);
+            break;
+
+        case URING_SEND:
+            if (game == NULL) {
+                break;
+            }
+            if (cqe->res < 0) {
+                uring_end_game(game);
+                break;
+            }
+
+            game->pending = 0;
+            if (game->over) {
+                uring_end_game(game);
+                break;
+            }
+            uring_next_round(reactor, game);
+            break;
+
+        default:
+            /* the wake pipe is readable, so quit is already set */
             break;
         }
     }
 
-    /* we are done */
-    free_resources();
-    return ret;
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+}
+
+static struct io_uring_sqe *uring_prepare(struct uring *ring, uint8_t opcode, int fd, uint64_t user_data)
+{
+    struct io_uring_sqe *sqe = uring_get_sqe(ring);
+    if (sqe == NULL) {
+        return NULL;
+    }
+
+    sqe->opcode    = opcode;
+    sqe->fd        = fd;
+    sqe->user_data = user_data;
+    return sqe;
+}
+
+static int uring_accept(struct uring *ring, int sockfd)
+{
+    struct io_uring_sqe *sqe = uring_prepare(ring, IORING_OP_ACCEPT, sockfd,
+                                             URING_DATA(URING_ACCEPT, 0, sockfd));
+    if (sqe == NULL) {
+        return -1;
+    }
+
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    return 0;
+}
+
+static int uring_recv(struct reactor *reactor, struct game *game)
+{
+    struct io_uring_sqe *sqe = uring_prepare(reactor->uring, IORING_OP_RECV, game->fd,
+                                             URING_DATA(URING_RECV, game->generation, game->fd));
+    if (sqe == NULL) {
+        return -1;
+    }
+
+    /* the kernel picks a buffer once data arrived, so no buffer is held by an idle connection */
+    sqe->ioprio    = IORING_RECV_MULTISHOT;
+    sqe->flags     = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BUFFER_GROUP;
+    return 0;
+}
+
+static void uring_received(struct reactor *reactor, struct game *game, struct io_uring_cqe *cqe)
+{
+    struct uring *ring = reactor->uring;
+
+    if (cqe->flags & IORING_CQE_F_BUFFER) {
+        uint16_t bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+
+        if (game != NULL && cqe->res > 0) {
+            /* bytes behind the last round of the game are dropped */
+            size_t size = cqe->res;
+            if (size > sizeof(game->input) - game->input_size) {
+                size = sizeof(game->input) - game->input_size;
+            }
+            (void) memcpy(game->input + game->input_size, ring->buffers + (size_t) bid * URING_BUFFER_SIZE, size);
+            game->input_size += size;
+        }
+
+        uring_recycle(ring, bid);
+    }
+
+    if (game == NULL) {
+        return;
+    }
+
+    if (cqe->res == 0) {
+        game->closed = 1;
+    } else if (cqe->res < 0 && cqe->res != -ENOBUFS) {
+        DEBUG("Connection %d: recv: %s\n", game->fd, strerror(-cqe->res));
+        uring_end_game(game);
+        return;
+    } else if (!(cqe->flags & IORING_CQE_F_MORE) && uring_recv(reactor, game) < 0) {
+        /* the multishot recv stopped, e.g. because no buffer was left */
+        uring_end_game(game);
+        return;
+    }
+
+    uring_next_round(reactor, game);
+}
+
+static void uring_next_round(struct reactor *reactor, struct game *game)
+{
+    /* continued once the response of the last round was sent */
+    if (game->pending) {
+        return;
+    }
+
+    if (game->input_size < READ_BYTES) {
+        if (game->closed) {
+            DEBUG("Connection %d: closed by client\n", game->fd);
+            uring_end_game(game);
+        }
+        return;
+    }
+
+    (void) memcpy(game->buffer, game->input, READ_BYTES);
+    game->input_size -= READ_BYTES;
+    (void) memmove(game->input, game->input + READ_BYTES, game->input_size);
+
+    play_round(game);
+
+    struct io_uring_sqe *sqe = uring_prepare(reactor->uring, IORING_OP_SEND, game->fd,
+                                             URING_DATA(URING_SEND, game->generation, game->fd));
+    if (sqe == NULL) {
+        uring_end_game(game);
+        return;
+    }
+
+    /* a client which closed its connection must not kill the server with SIGPIPE */
+    sqe->addr      = (uintptr_t) &response_bytes[game->response];
+    sqe->len       = WRITE_BYTES;
+    sqe->msg_flags = MSG_NOSIGNAL;
+}
+
+static void uring_recycle(struct uring *ring, uint16_t bid)
+{
+    struct io_uring_buf *buf = &ring->buf_ring->bufs[ring->buf_tail & (URING_BUFFERS - 1)];
+
+    buf->addr = (uintptr_t) (ring->buffers + (size_t) bid * URING_BUFFER_SIZE);
+    buf->len  = URING_BUFFER_SIZE;
+    buf->bid  = bid;
+    ring->buf_tail++;
+}
+
+static void uring_end_game(struct game *game)
+{
+    /* the multishot recv holds a reference of the socket, so it has to be shut down */
+    (void) shutdown(game->fd, SHUT_RDWR);
+    end_game(game);
+}
+#else
+static int run_uring(struct reactor *reactor)
+{
+    errno = ENOSYS;
+    return -1;
+}
+#endif
+
+static int set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0) {
+        return -1;
+    }
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
 }
 
 static void parse_args(int argc, char **argv, struct opts *options)
 {
     int i;
+    int opt;
     char *port_arg;
     char *secret_arg;
     char *endptr;
@@ -404,12 +1399,51 @@ static void parse_args(int argc, char **argv, struct opts *options)
     if(argc > 0) {
         progname = argv[0];
     }
-    if (argc != 3) {
+
+    options->threads = 0;
+    options->uring = 0;
+    options->secret = 0;
+    while ((opt = getopt(argc, argv, "t:u")) != -1) {
+        switch (opt) {
+        case 't':
+            if (options->threads != 0) {
+                bail_out(EXIT_FAILURE, "-t was specified more than once");
+            }
+
+            errno = 0;
+            options->threads = strtol(optarg, &endptr, 10);
+            if (errno != 0 || endptr == optarg || *endptr != '\0'
+                || options->threads < 1 || options->threads > MAX_THREADS) {
+                errno = 0;
+                bail_out(EXIT_FAILURE,
+                    "<threads> has to be a number between 1 and %d", MAX_THREADS);
+            }
+            break;
+        case 'u':
+#ifdef HAVE_IO_URING
+            options->uring = 1;
+#else
+            errno = 0;
+            bail_out(EXIT_FAILURE, "-u: io_uring is not supported by this build");
+#endif
+            break;
+        default:
+            bail_out(EXIT_FAILURE,
+                "Usage: %s [-t threads] [-u] <server-port> <secret-sequence>", progname);
+        }
+    }
+
+    /* a single event loop unless more threads were requested */
+    if (options->threads == 0) {
+        options->threads = 1;
+    }
+
+    if (argc - optind != 2) {
         bail_out(EXIT_FAILURE,
-            "Usage: %s <server-port> <secret-sequence>", progname);
+            "Usage: %s [-t threads] [-u] <server-port> <secret-sequence>", progname);
     }
-    port_arg = argv[1];
-    secret_arg = argv[2];
+    port_arg = argv[optind];
+    secret_arg = argv[optind + 1];
 
     errno = 0;
     options->portno = strtol(port_arg, &endptr, 10);
@@ -474,6 +1508,6 @@ static void parse_args(int argc, char **argv, struct opts *options)
             bail_out(EXIT_FAILURE,
                 "Bad Color '%c' in <secret-sequence>", secret_arg[i]);
         }
-        options->secret[i] = color;
+        options->secret |= color << (SHIFT_WIDTH * i);
     }
 }
@@ -0,0 +1,354 @@
+/*
+ * Implementation of the strategies of the client, see strategy.h
+ *
+ * A scored strategy builds for every candidate guess the histogram of the
+ * answers over the population. The population is compacted into an array
+ * of codes and their color counts first, so the scoring kernel only has to
+ * compute the counts of the guess once per histogram.
+ *
+ * The candidate guesses are handed out in chunks to the threads of a pool,
+ * every thread builds its histograms on its own stack and keeps its best
+ * guess. The best guesses of the threads are reduced by the calling thread.
+ * Ties are broken by the code, so the guess does not depend on the number
+ * of threads.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <signal.h>
+#include <pthread.h>
+
+#include "strategy.h"
+
+/* === Constants === */
+
+/* All codes are candidate guesses as long as the histograms take at most this many answers,
+   otherwise only the codes of the population are scored */
+#define MAX_SCORED_PAIRS (1L << 26)
+
+/* number of guesses which a thread takes at once */
+#define GUESS_CHUNK (64)
+
+/* === Type Definitions === */
+
+struct candidate {
+	double score;		/* lower is better */
+	int consistent;		/* is the guess in the population and could win? */
+	uint16_t code;
+};
+
+/*
+ * @brief the scoring of the guesses of a round, it is shared by the threads
+ */
+struct scoring {
+	enum strategy strategy;
+	const uint64_t *population;
+	/* are all codes scored or only the ones of the population? */
+	int allCodes;
+	int guesses;
+	/* the first guess which was not taken by a thread yet */
+	int next;
+};
+
+/*
+ * @brief a thread of the pool, the first one is the calling thread
+ */
+struct worker {
+	pthread_t thread;
+	/* the best guess of the thread in the current round */
+	struct candidate best;
+};
+
+/* === Global Variables === */
+
+/* the compacted population and the color counts of its codes */
+static uint16_t secrets[CODES];
+static uint32_t secretCounts[CODES];
+static int secretsSize = 0;
+
+/* the threads of the pool */
+static struct worker workers[STRATEGY_MAX_THREADS];
+static long workerCount = 1;
+
+/* the scoring of the current round */
+static struct scoring scoring;
+
+/* the workers wait for a new round (generation) and the caller until no worker is pending */
+static pthread_mutex_t poolLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t poolWork  = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t poolDone  = PTHREAD_COND_INITIALIZER;
+static unsigned long generation = 0;
+static long pending = 0;
+static int stopping = 0;
+
+/* === Prototypes === */
+
+/**
+ * @brief returns the code of the population with the given index
+ * @param population the population
+ * @param index the index of the code, smaller than the size of the population
+ * @return the code
+ */
+static uint16_t selectCode(const uint64_t population[CODE_WORDS], int index);
+
+/**
+ * @brief fills secrets and secretCounts with the codes of the population
+ * @param population the population
+ */
+static void compactPopulation(const uint64_t population[CODE_WORDS]);
+
+/**
+ * @brief the routine of the threads of the pool, scores the guesses of every round
+ * @param argument the worker
+ * @return always NULL
+ */
+static void *workerMain(void *argument);
+
+/**
+ * @brief scores chunks of the guesses of the current round until all are taken
+ * @param best is set to the best guess which was scored
+ */
+static void scoreGuesses(struct candidate *best);
+
+/**
+ * @brief counts the answers to the guess over the compacted population
+ * @param guess the guess
+ * @param histogram is set to the number of secrets per answer
+ */
+static void buildHistogram(uint16_t guess, uint32_t histogram[ANSWERS]);
+
+/**
+ * @brief scores the partitions of the population given by a histogram
+ * @param strategy STRATEGY_MINIMAX or STRATEGY_ENTROPY
+ * @param histogram the number of secrets per answer
+ * @return the score, lower is better
+ */
+static double scorePartitions(enum strategy strategy, const uint32_t histogram[ANSWERS]);
+
+/**
+ * @brief returns true if candidate a is a better guess than b
+ */
+static int isBetter(const struct candidate *a, const struct candidate *b);
+
+/* === Implementations === */
+
+long strategy_init(long threads) {
+	/* SIGINT should interrupt the thread which talks to the server */
+	sigset_t blocked, previous;
+	(void) sigemptyset(&blocked);
+	(void) sigaddset(&blocked, SIGINT);
+	(void) pthread_sigmask(SIG_BLOCK, &blocked, &previous);
+
+	for( workerCount = 1; workerCount < threads; workerCount++ ) {
+		if( pthread_create(&workers[workerCount].thread, NULL, workerMain, &workers[workerCount]) != 0 ) {
+			break;
+		}
+	}
+
+	(void) pthread_sigmask(SIG_SETMASK, &previous, NULL);
+	return workerCount;
+}
+
+void strategy_free(void) {
+	(void) pthread_mutex_lock(&poolLock);
+	stopping = 1;
+	(void) pthread_cond_broadcast(&poolWork);
+	(void) pthread_mutex_unlock(&poolLock);
+
+	for( long i = 1; i < workerCount; i++ ) {
+		(void) pthread_join(workers[i].thread, NULL);
+	}
+	workerCount = 1;
+}
+
+int strategy_parse(const char *name, enum strategy *strategy) {
+	if( strcmp(name, "random") == 0 ) {
+		*strategy = STRATEGY_RANDOM;
+	} else if( strcmp(name, "minimax") == 0 ) {
+		*strategy = STRATEGY_MINIMAX;
+	} else if( strcmp(name, "entropy") == 0 ) {
+		*strategy = STRATEGY_ENTROPY;
+	} else {
+		return -1;
+	}
+
+	return 0;
+}
+
+uint16_t strategy_select(enum strategy strategy, const uint64_t population[CODE_WORDS], int populationSize) {
+	if( strategy == STRATEGY_RANDOM ) {
+		return selectCode(population, rand() % populationSize);
+	}
+
+	compactPopulation(population);
+
+	/* any of two codes splits them into single codes, the scores would pick the first one */
+	if( secretsSize <= 2 ) {
+		return secrets[0];
+	}
+
+	/* the whole code space is scored once the population got small enough */
+	const int allCodes = (long)populationSize * CODES <= MAX_SCORED_PAIRS;
+	const int guesses  = allCodes ? CODES : secretsSize;
+
+	scoring.strategy   = strategy;
+	scoring.population = population;
+	scoring.allCodes   = allCodes;
+	scoring.guesses    = guesses;
+	scoring.next       = 0;
+
+	/* start the round of the workers and take part in it */
+	(void) pthread_mutex_lock(&poolLock);
+	generation++;
+	pending = workerCount - 1;
+	(void) pthread_cond_broadcast(&poolWork);
+	(void) pthread_mutex_unlock(&poolLock);
+
+	scoreGuesses(&workers[0].best);
+
+	(void) pthread_mutex_lock(&poolLock);
+	while( pending > 0 ) {
+		(void) pthread_cond_wait(&poolDone, &poolLock);
+	}
+	(void) pthread_mutex_unlock(&poolLock);
+
+	/* the best of the best guesses of all threads */
+	struct candidate best = workers[0].best;
+	for( long i = 1; i < workerCount; i++ ) {
+		if( isBetter(&workers[i].best, &best) ) {
+			best = workers[i].best;
+		}
+	}
+
+	return best.code;
+}
+
+static void *workerMain(void *argument) {
+	struct worker *worker = (struct worker*) argument;
+	unsigned long seen = 0;
+
+	for(;;) {
+		(void) pthread_mutex_lock(&poolLock);
+		while( generation == seen && stopping == 0 ) {
+			(void) pthread_cond_wait(&poolWork, &poolLock);
+		}
+		seen = generation;
+		const int stop = stopping;
+		(void) pthread_mutex_unlock(&poolLock);
+
+		if( stop != 0 ) {
+			return NULL;
+		}
+
+		scoreGuesses(&worker->best);
+
+		(void) pthread_mutex_lock(&poolLock);
+		if( --pending == 0 ) {
+			(void) pthread_cond_signal(&poolDone);
+		}
+		(void) pthread_mutex_unlock(&poolLock);
+	}
+}
+
+static void scoreGuesses(struct candidate *best) {
+	uint32_t histogram[ANSWERS];
+
+	best->score = INFINITY;
+	best->consistent = 0;
+	best->code = CODE_MASK;
+
+	for(;;) {
+		const int first = __atomic_fetch_add(&scoring.next, GUESS_CHUNK, __ATOMIC_RELAXED);
+		if( first >= scoring.guesses ) {
+			return;
+		}
+
+		const int last = first + GUESS_CHUNK < scoring.guesses ? first + GUESS_CHUNK : scoring.guesses;
+		for( int i = first; i < last; i++ ) {
+			struct candidate current;
+
+			current.code = scoring.allCodes ? (uint16_t) i : secrets[i];
+			current.consistent = scoring.allCodes ? (int)((scoring.population[i / 64] >> (i % 64)) & 1) : 1;
+
+			buildHistogram(current.code, histogram);
+			current.score = scorePartitions(scoring.strategy, histogram);
+
+			if( isBetter(&current, best) ) {
+				*best = current;
+			}
+		}
+	}
+}
+
+static uint16_t selectCode(const uint64_t population[CODE_WORDS], int index) {
+	int word = 0;
+	while (index >= __builtin_popcountll(population[word])) {
+		index -= __builtin_popcountll(population[word]);
+		word++;
+	}
+
+	/* drop the lower codes of the word until the wanted one is the lowest */
+	uint64_t codes = population[word];
+	for (; index > 0; index--) {
+		codes &= codes - 1;
+	}
+
+	return (uint16_t)(word * 64 + __builtin_ctzll(codes));
+}
+
+static void compactPopulation(const uint64_t population[CODE_WORDS]) {
+	secretsSize = 0;
+	for( int word = 0; word < CODE_WORDS; word++ ) {
+		uint64_t codes = population[word];
+
+		while( codes != 0 ) {
+			const uint16_t code = (uint16_t)(word * 64 + __builtin_ctzll(codes));
+			codes &= codes - 1;
+
+			secrets[secretsSize]      = code;
+			secretCounts[secretsSize] = mastermind_color_counts(code);
+			secretsSize++;
+		}
+	}
+}
+
+static void buildHistogram(uint16_t guess, uint32_t histogram[ANSWERS]) {
+	const uint32_t guessed = mastermind_color_counts(guess);
+
+	(void) memset(histogram, 0, ANSWERS * sizeof(uint32_t));
+	for( int i = 0; i < secretsSize; i++ ) {
+		histogram[ mastermind_answer_counted(guess, guessed, secrets[i], secretCounts[i]) ]++;
+	}
+}
+
+static double scorePartitions(enum strategy strategy, const uint32_t histogram[ANSWERS]) {
+	double score = 0;
+
+	for( int answer = 0; answer < ANSWERS; answer++ ) {
+		const double size = histogram[answer];
+
+		if( strategy == STRATEGY_MINIMAX ) {
+			score = size > score ? size : score;
+		} else if( size > 1 ) {
+			/* the expected information is log(N) - sum(n log n) / N, N is the same for all guesses */
+			score += size * log(size);
+		}
+	}
+
+	return score;
+}
+
+static int isBetter(const struct candidate *a, const struct candidate *b) {
+	if( a->score != b->score ) {
+		return a->score < b->score;
+	}
+
+	if( a->consistent != b->consistent ) {
+		return a->consistent > b->consistent;
+	}
+
+	return a->code < b->code;
+}
@@ -0,0 +1,65 @@
+/*
+ * This header file does contain the strategies of the client to choose the
+ * next guess from the codes which are still possible. The random strategy
+ * picks any of them, the others score every candidate guess by the sizes
+ * of the partitions its answers would split the population into. The
+ * candidate guesses are scored by a pool of threads.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#ifndef STRATEGY_H
+#define STRATEGY_H
+
+#include <stdint.h>
+
+#include "mastermind.h"
+
+/* === Constants === */
+
+/* maximum number of threads which score the guesses */
+#define STRATEGY_MAX_THREADS (256)
+
+/* the first guess of the client and of the strategy trees: bdgor */
+#define STRATEGY_FIRST_GUESS (0x4688)
+
+/* === Type Definitions === */
+
+enum strategy {
+	STRATEGY_RANDOM = 0,	/* a random code of the population */
+	STRATEGY_MINIMAX,	/* Knuth: the smallest worst case partition */
+	STRATEGY_ENTROPY	/* the highest expected information of the answer */
+};
+
+/* === Prototypes === */
+
+/**
+ * @brief starts the threads which score the guesses, the calling thread is one of them
+ * @param threads the number of threads, between 1 and STRATEGY_MAX_THREADS
+ * @return the number of threads which could be started, at least 1
+ */
+long strategy_init(long threads);
+
+/**
+ * @brief stops the threads started by strategy_init
+ */
+void strategy_free(void);
+
+/**
+ * @brief parses the name of a strategy
+ * @param name the name as given on the command line (random, minimax or entropy)
+ * @param strategy is set to the strategy with this name
+ * @return 0 on success otherwise -1 if there is no such strategy
+ */
+int strategy_parse(const char *name, enum strategy *strategy);
+
+/**
+ * @brief chooses the next guess
+ * @param strategy the strategy which is used
+ * @param population bitset of the codes which are still possible, bit i of word w is the code 64 * w + i
+ * @param populationSize the number of codes in the population, greater than 0
+ * @return the guess without parity bit
+ */
+uint16_t strategy_select(enum strategy strategy, const uint64_t population[CODE_WORDS], int populationSize);
+
+#endif
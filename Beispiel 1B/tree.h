@@ -0,0 +1,45 @@
+/*
+ * This header file does contain the format of a precomputed strategy tree,
+ * which is written by gentree and used in place by the client. The file is
+ * the header followed by the nodes, node 0 is the first guess. A node holds
+ * its guess and for every answer the index of the node with the next guess,
+ * so a round is a single lookup. The numbers are stored in the byte order
+ * of the machine which generated the file.
+ *
+ * @author Raphael Ludwig (e1526280)
+ */
+
+#ifndef TREE_H
+#define TREE_H
+
+#include <stdint.h>
+
+#include "mastermind.h"
+
+/* === Constants === */
+
+/* the magic at the start of a tree file, it includes the version of the format */
+#define TREE_MAGIC ("MMTREE1")
+#define TREE_MAGIC_SIZE (8)
+
+/* child index of the answers which can not occur or win the game, node 0 is never a child */
+#define TREE_NO_CHILD (0)
+
+/* === Type Definitions === */
+
+struct tree_header {
+	char magic[TREE_MAGIC_SIZE];
+	/* number of nodes behind the header */
+	uint32_t nodes;
+	uint32_t reserved;
+};
+
+struct tree_node {
+	/* the guess without parity bit */
+	uint16_t guess;
+	uint16_t reserved;
+	/* the index of the next node for every answer (reds | whites << SHIFT_WIDTH) */
+	uint32_t children[ANSWERS];
+};
+
+#endif